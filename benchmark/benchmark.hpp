@@ -0,0 +1,99 @@
+#pragma once
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <ouroboros/cyclic_deque.hpp>
+#include <string>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace benchmark {
+
+using clock = std::chrono::steady_clock;
+
+//! \brief Pin the calling thread to \p core, modulo the number of available
+//! hardware threads. Only supported on Linux. A no-op otherwise.
+inline void pin_to_core(unsigned core) {
+#if defined(__linux__)
+  unsigned n = std::thread::hardware_concurrency();
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(n > 0 ? core % n : 0, &set);
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+  (void)core;
+#endif
+}
+
+//! \brief Return the number of seconds between \p begin and \p end.
+inline double seconds(clock::time_point begin, clock::time_point end) {
+  return std::chrono::duration<double>(end - begin).count();
+}
+
+//! \brief Return the value of the first command line argument as a number, or
+//! \p fallback when it is missing.
+inline std::size_t arg_or(int argc, char** argv, std::size_t fallback) {
+  return argc > 1 ? std::strtoull(argv[1], nullptr, 10) : fallback;
+}
+
+//! \brief Print a single result row: name, total seconds, nanoseconds per
+//! operation and millions of operations per second.
+inline void report(std::string const& name, double seconds, double ops) {
+  std::cout << std::left << std::setw(44) << name << std::right << std::fixed
+            << std::setprecision(3) << std::setw(10) << seconds << " s"
+            << std::setw(10) << std::setprecision(2) << seconds * 1e9 / ops
+            << " ns/op" << std::setw(10) << ops / seconds / 1e6 << " Mops/s"
+            << std::endl;
+}
+
+//! \brief Prevent the compiler from optimizing away \p value.
+template <typename T_>
+inline void do_not_optimize(T_ const& value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static T_ volatile sink;
+  sink = value;
+#endif
+}
+
+//! \brief The baseline for the concurrent queues: an
+//! ouroboros::cyclic_deque<> guarded by a single mutex.
+template <typename T_>
+class locked_cyclic_deque {
+ public:
+  explicit locked_cyclic_deque(std::size_t capacity) : deque_(capacity) {}
+
+  template <typename U_>
+  bool try_push(U_&& value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (deque_.full()) {
+      return false;
+    }
+    deque_.push_back(std::forward<U_>(value));
+    return true;
+  }
+
+  bool try_pop(T_& value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (deque_.empty()) {
+      return false;
+    }
+    value = std::move(deque_.front());
+    deque_.pop_front();
+    return true;
+  }
+
+ private:
+  std::mutex mutex_;
+  ouroboros::cyclic_deque<T_> deque_;
+};
+
+}  // namespace benchmark
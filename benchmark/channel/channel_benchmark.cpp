@@ -0,0 +1,108 @@
+#include <benchmark.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <ouroboros/channel.hpp>
+#include <ouroboros/cyclic_deque.hpp>
+
+// Measures the throughput of a producer and a consumer coroutine that
+// communicate through a channel on a single thread. The baseline is a
+// producer and a consumer thread that communicate through a cyclic_deque that
+// is guarded by a mutex and two condition variables.
+
+namespace {
+
+constexpr std::size_t kCapacity = 1024;
+
+ouroboros::detached_task Produce(
+    ouroboros::channel<std::uint64_t>& ch, std::size_t count) {
+  for (std::uint64_t i = 0; i < count; ++i) {
+    co_await ch.push(i);
+  }
+  ch.close();
+}
+
+ouroboros::detached_task Consume(
+    ouroboros::channel<std::uint64_t>& ch, std::uint64_t& sum) {
+  while (auto v = co_await ch.pop()) {
+    sum += *v;
+  }
+}
+
+double RunChannel(std::size_t count) {
+  ouroboros::executor e;
+  ouroboros::channel<std::uint64_t> ch(e, kCapacity);
+  std::uint64_t sum = 0;
+  auto begin = benchmark::clock::now();
+  e.spawn(Consume(ch, sum));
+  e.spawn(Produce(ch, count));
+  e.run();
+  auto end = benchmark::clock::now();
+  benchmark::do_not_optimize(sum);
+  return benchmark::seconds(begin, end);
+}
+
+class CondvarQueue {
+ public:
+  explicit CondvarQueue(std::size_t capacity) : deque_(capacity) {}
+
+  void Push(std::uint64_t value) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock, [this]() { return !deque_.full(); });
+    deque_.push_back(value);
+    lock.unlock();
+    not_empty_.notify_one();
+  }
+
+  std::uint64_t Pop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_empty_.wait(lock, [this]() { return !deque_.empty(); });
+    std::uint64_t value = deque_.front();
+    deque_.pop_front();
+    lock.unlock();
+    not_full_.notify_one();
+    return value;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+  ouroboros::cyclic_deque<std::uint64_t> deque_;
+};
+
+double RunCondvar(std::size_t count) {
+  CondvarQueue queue(kCapacity);
+  auto begin = benchmark::clock::now();
+  std::thread producer([&queue, count]() {
+    benchmark::pin_to_core(0);
+    for (std::uint64_t i = 0; i < count; ++i) {
+      queue.Push(i);
+    }
+  });
+  std::thread consumer([&queue, count]() {
+    benchmark::pin_to_core(1);
+    std::uint64_t sum = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      sum += queue.Pop();
+    }
+    benchmark::do_not_optimize(sum);
+  });
+  producer.join();
+  consumer.join();
+  return benchmark::seconds(begin, benchmark::clock::now());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::size_t count = benchmark::arg_or(argc, argv, 10000000);
+  double ops = static_cast<double>(count);
+
+  std::cout << "items: " << count << ", capacity: " << kCapacity << std::endl;
+  benchmark::report("channel (coroutines, 1 thread)", RunChannel(count), ops);
+  benchmark::report(
+      "mutex + condvar + cyclic_deque (2 threads)", RunCondvar(count), ops);
+
+  return 0;
+}
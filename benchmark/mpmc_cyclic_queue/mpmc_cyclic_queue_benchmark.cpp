@@ -0,0 +1,82 @@
+#include <atomic>
+#include <benchmark.hpp>
+#include <cstdint>
+#include <ouroboros/mpmc_cyclic_queue.hpp>
+#include <vector>
+
+// Measures the scalability of the queue with an equal number of producer and
+// consumer threads, from 1 up to 64 of each. The mutex guarded cyclic_deque is
+// the baseline.
+
+namespace {
+
+constexpr std::size_t kCapacity = 4096;
+
+template <typename Queue_>
+double Run(std::size_t threads, std::size_t count) {
+  Queue_ queue(kCapacity);
+  std::size_t per_producer = count / threads;
+  std::atomic<std::size_t> remaining{per_producer * threads};
+  std::atomic<bool> go{false};
+
+  std::vector<std::thread> workers;
+  for (std::size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t]() {
+      benchmark::pin_to_core(static_cast<unsigned>(2 * t));
+      while (!go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+      for (std::uint64_t i = 0; i < per_producer; ++i) {
+        while (!queue.try_push(i)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+    workers.emplace_back([&, t]() {
+      benchmark::pin_to_core(static_cast<unsigned>(2 * t + 1));
+      while (!go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+      std::uint64_t sum = 0;
+      std::uint64_t v;
+      while (remaining.load(std::memory_order_relaxed) > 0) {
+        if (queue.try_pop(v)) {
+          sum += v;
+          remaining.fetch_sub(1, std::memory_order_relaxed);
+        } else {
+          std::this_thread::yield();
+        }
+      }
+      benchmark::do_not_optimize(sum);
+    });
+  }
+
+  auto begin = benchmark::clock::now();
+  go.store(true, std::memory_order_release);
+  for (auto& w : workers) {
+    w.join();
+  }
+  return benchmark::seconds(begin, benchmark::clock::now());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::size_t count = benchmark::arg_or(argc, argv, 4000000);
+  using mpmc = ouroboros::mpmc_cyclic_queue<std::uint64_t>;
+  using locked = benchmark::locked_cyclic_deque<std::uint64_t>;
+
+  std::cout << "items: " << count
+            << ", hardware threads: " << std::thread::hardware_concurrency()
+            << std::endl;
+  for (std::size_t threads = 1; threads <= 64; threads *= 2) {
+    std::string suffix = " " + std::to_string(threads) + "P/" +
+                         std::to_string(threads) + "C";
+    std::size_t n = count / threads * threads;
+    benchmark::report("mpmc_cyclic_queue" + suffix, Run<mpmc>(threads, n), n);
+    benchmark::report(
+        "mutex + cyclic_deque" + suffix, Run<locked>(threads, n), n);
+  }
+
+  return 0;
+}
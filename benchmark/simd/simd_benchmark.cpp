@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <benchmark.hpp>
+#include <cstdint>
+#include <ouroboros/cyclic_deque.hpp>
+#include <ouroboros/simd.hpp>
+#include <string>
+
+// Measures sum, minmax, count_if_eq, dot and scale over a full, wrapped
+// cyclic_deque for each instruction set the processor supports. The baseline
+// is the scalar loop over the iterators of the cyclic_deque.
+
+namespace {
+
+char const* Name(ouroboros::simd::level l) {
+  switch (l) {
+    case ouroboros::simd::level::avx512:
+      return "avx512";
+    case ouroboros::simd::level::avx2:
+      return "avx2";
+    case ouroboros::simd::level::sse2:
+      return "sse2";
+    default:
+      return "scalar";
+  }
+}
+
+template <typename T_>
+ouroboros::cyclic_deque<T_> Ring(std::size_t n, std::size_t offset) {
+  ouroboros::cyclic_deque<T_> ring(n);
+  // Wraps around such that the values are split across both segments.
+  for (std::size_t i = 0; i < offset; ++i) {
+    ring.push_back(T_(0));
+  }
+  ring.pop_front(offset);
+  for (std::size_t i = 0; i < n; ++i) {
+    ring.push_back(static_cast<T_>(i % 7));
+  }
+  return ring;
+}
+
+template <typename Ring_, typename F_>
+double Run(Ring_& ring, std::size_t rounds, F_ f) {
+  auto begin = benchmark::clock::now();
+  for (std::size_t i = 0; i < rounds; ++i) {
+    benchmark::do_not_optimize(f(ring));
+  }
+  return benchmark::seconds(begin, benchmark::clock::now());
+}
+
+template <typename T_>
+void Benchmark(std::string const& type, std::size_t n, std::size_t rounds) {
+  auto ring = Ring<T_>(n, n / 3);
+  // The segments of other are split at a different position than those of
+  // ring.
+  auto const other = Ring<T_>(n, n / 2);
+  std::size_t ops = n * rounds;
+  std::string suffix = " " + type + " n=" + std::to_string(n);
+
+  benchmark::report(
+      "iterator sum" + suffix,
+      Run(ring,
+          rounds,
+          [](auto const& r) {
+            T_ sum = 0;
+            for (T_ v : r) {
+              sum += v;
+            }
+            return sum;
+          }),
+      ops);
+  benchmark::report(
+      "iterator minmax" + suffix,
+      Run(ring,
+          rounds,
+          [](auto const& r) {
+            auto m = std::minmax_element(r.begin(), r.end());
+            return *m.first + *m.second;
+          }),
+      ops);
+  benchmark::report(
+      "iterator count_if_eq" + suffix,
+      Run(ring,
+          rounds,
+          [](auto const& r) { return std::count(r.begin(), r.end(), T_(3)); }),
+      ops);
+  benchmark::report(
+      "iterator dot" + suffix,
+      Run(ring,
+          rounds,
+          [&other](auto const& r) {
+            T_ dot = 0;
+            auto it = other.begin();
+            for (T_ v : r) {
+              dot += v * *it++;
+            }
+            return dot;
+          }),
+      ops);
+  // Scaling by -1 keeps the values bounded over all rounds.
+  benchmark::report(
+      "iterator scale" + suffix,
+      Run(ring,
+          rounds,
+          [](auto& r) {
+            for (T_& v : r) {
+              v *= T_(-1);
+            }
+            return r.front();
+          }),
+      ops);
+
+  auto supported = ouroboros::simd::supported_level();
+  for (auto l :
+       {ouroboros::simd::level::scalar,
+        ouroboros::simd::level::sse2,
+        ouroboros::simd::level::avx2,
+        ouroboros::simd::level::avx512}) {
+    if (supported < l) {
+      break;
+    }
+    ouroboros::simd::set_level(l);
+    std::string name = std::string(" (") + Name(l) + ")" + suffix;
+    benchmark::report(
+        "simd::sum" + name,
+        Run(ring,
+            rounds,
+            [](auto const& r) { return ouroboros::simd::sum(r); }),
+        ops);
+    benchmark::report(
+        "simd::minmax" + name,
+        Run(ring,
+            rounds,
+            [](auto const& r) {
+              auto m = ouroboros::simd::minmax(r);
+              return m.first + m.second;
+            }),
+        ops);
+    benchmark::report(
+        "simd::count_if_eq" + name,
+        Run(ring,
+            rounds,
+            [](auto const& r) {
+              return ouroboros::simd::count_if_eq(r, T_(3));
+            }),
+        ops);
+    benchmark::report(
+        "simd::dot" + name,
+        Run(ring,
+            rounds,
+            [&other](auto const& r) { return ouroboros::simd::dot(r, other); }),
+        ops);
+    benchmark::report(
+        "simd::scale" + name,
+        Run(ring,
+            rounds,
+            [](auto& r) {
+              ouroboros::simd::scale(r, T_(-1));
+              return r.front();
+            }),
+        ops);
+  }
+  ouroboros::simd::set_level(supported);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::size_t count = benchmark::arg_or(argc, argv, 100000000);
+
+  std::cout << "items: " << count << std::endl;
+  for (std::size_t n : {1000, 100000}) {
+    std::size_t rounds = std::max<std::size_t>(count / n, 1);
+    Benchmark<float>("float", n, rounds);
+    Benchmark<double>("double", n, rounds);
+    Benchmark<std::int32_t>("int32", n, rounds);
+    Benchmark<std::int8_t>("int8", n, rounds);
+  }
+
+  return 0;
+}
@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <benchmark.hpp>
+#include <cstdint>
+#include <ouroboros/cyclic_deque.hpp>
+#include <ouroboros/sliding_quantile.hpp>
+#include <random>
+#include <vector>
+
+// Measures the cost of pushing a value into a full window and querying the
+// median and the 99th percentile, for several window sizes. The baseline
+// copies a cyclic_deque into a vector and uses std::nth_element for each
+// quantile.
+
+namespace {
+
+std::vector<std::uint32_t> Values(std::size_t count) {
+  std::mt19937 gen(1);
+  std::vector<std::uint32_t> values(count);
+  for (auto& v : values) {
+    v = gen();
+  }
+  return values;
+}
+
+double Baseline(std::vector<std::uint32_t> const& values, std::size_t n) {
+  ouroboros::cyclic_deque<std::uint32_t> window(n);
+  std::vector<std::uint32_t> copy;
+  copy.reserve(n);
+  std::uint64_t sum = 0;
+  auto begin = benchmark::clock::now();
+  for (std::uint32_t v : values) {
+    if (window.full()) {
+      window.pop_front();
+    }
+    window.push_back(v);
+    copy.assign(window.begin(), window.end());
+    auto p50 = copy.begin() + static_cast<std::ptrdiff_t>(copy.size() / 2);
+    std::nth_element(copy.begin(), p50, copy.end());
+    auto p99 =
+        copy.begin() + static_cast<std::ptrdiff_t>(copy.size() * 99 / 100);
+    std::nth_element(p50, p99, copy.end());
+    sum += *p50 + *p99;
+  }
+  benchmark::do_not_optimize(sum);
+  return benchmark::seconds(begin, benchmark::clock::now());
+}
+
+double SlidingQuantile(
+    std::vector<std::uint32_t> const& values, std::size_t n) {
+  ouroboros::sliding_quantile<std::uint32_t> window(n);
+  std::uint64_t sum = 0;
+  auto begin = benchmark::clock::now();
+  for (std::uint32_t v : values) {
+    window.push(v);
+    sum += window.quantile(0.5) + window.quantile(0.99);
+  }
+  benchmark::do_not_optimize(sum);
+  return benchmark::seconds(begin, benchmark::clock::now());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::size_t count = benchmark::arg_or(argc, argv, 1000000);
+  auto values = Values(count);
+
+  std::cout << "items: " << count << std::endl;
+  for (std::size_t n : {64, 1024, 16384}) {
+    std::string suffix = " n=" + std::to_string(n);
+    benchmark::report(
+        "sliding_quantile" + suffix, SlidingQuantile(values, n), count);
+    // The baseline is O(N) per item. Fewer items keep the run time down.
+    std::vector<std::uint32_t> head(
+        values.begin(),
+        values.begin() + static_cast<std::ptrdiff_t>(
+                             std::min(count, count * 64 / n + n)));
+    benchmark::report(
+        "copy + nth_element" + suffix, Baseline(head, n), head.size());
+  }
+
+  return 0;
+}
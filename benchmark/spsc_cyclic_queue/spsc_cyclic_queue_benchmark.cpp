@@ -0,0 +1,143 @@
+#include <benchmark.hpp>
+#include <cstdint>
+#include <ouroboros/spsc_cyclic_queue.hpp>
+#include <vector>
+
+// Measures the throughput of a producer and a consumer thread pinned to
+// different cores, and the one-way handoff latency derived from a ping-pong
+// between two queues. The mutex guarded cyclic_deque is the baseline.
+
+namespace {
+
+constexpr std::size_t kCapacity = 4096;
+constexpr std::size_t kBatch = 64;
+
+template <typename Queue_>
+double Throughput(std::size_t count) {
+  Queue_ queue(kCapacity);
+  auto begin = benchmark::clock::now();
+  std::thread producer([&queue, count]() {
+    benchmark::pin_to_core(0);
+    for (std::uint64_t i = 0; i < count; ++i) {
+      while (!queue.try_push(i)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  benchmark::pin_to_core(1);
+  std::uint64_t sum = 0;
+  std::uint64_t v;
+  for (std::size_t i = 0; i < count; ++i) {
+    while (!queue.try_pop(v)) {
+      std::this_thread::yield();
+    }
+    sum += v;
+  }
+  producer.join();
+  benchmark::do_not_optimize(sum);
+  return benchmark::seconds(begin, benchmark::clock::now());
+}
+
+double ThroughputBatched(std::size_t count) {
+  ouroboros::spsc_cyclic_queue<std::uint64_t> queue(kCapacity);
+  auto begin = benchmark::clock::now();
+  std::thread producer([&queue, count]() {
+    benchmark::pin_to_core(0);
+    std::vector<std::uint64_t> batch(kBatch);
+    for (std::uint64_t i = 0; i < count;) {
+      std::size_t n = std::min<std::size_t>(kBatch, count - i);
+      for (std::size_t j = 0; j < n; ++j) {
+        batch[j] = i + j;
+      }
+      std::size_t pushed = 0;
+      while (pushed < n) {
+        pushed += queue.try_push_n(batch.begin() + pushed, n - pushed);
+        if (pushed < n) {
+          std::this_thread::yield();
+        }
+      }
+      i += n;
+    }
+  });
+
+  benchmark::pin_to_core(1);
+  std::vector<std::uint64_t> batch(kBatch);
+  std::uint64_t sum = 0;
+  for (std::size_t i = 0; i < count;) {
+    std::size_t n = queue.try_pop_n(batch.begin(), kBatch);
+    if (n == 0) {
+      std::this_thread::yield();
+    }
+    for (std::size_t j = 0; j < n; ++j) {
+      sum += batch[j];
+    }
+    i += n;
+  }
+  producer.join();
+  benchmark::do_not_optimize(sum);
+  return benchmark::seconds(begin, benchmark::clock::now());
+}
+
+// The time of a round trip divided by two. Spins without yielding, so the
+// result is only meaningful when two cores are available.
+template <typename Queue_>
+double PingPong(std::size_t count) {
+  Queue_ ping(kCapacity);
+  Queue_ pong(kCapacity);
+  auto begin = benchmark::clock::now();
+  std::thread echo([&ping, &pong, count]() {
+    benchmark::pin_to_core(0);
+    std::uint64_t v;
+    for (std::size_t i = 0; i < count; ++i) {
+      while (!ping.try_pop(v)) {
+      }
+      while (!pong.try_push(v)) {
+      }
+    }
+  });
+
+  benchmark::pin_to_core(1);
+  std::uint64_t v;
+  for (std::uint64_t i = 0; i < count; ++i) {
+    while (!ping.try_push(i)) {
+    }
+    while (!pong.try_pop(v)) {
+    }
+  }
+  echo.join();
+  return benchmark::seconds(begin, benchmark::clock::now()) / 2.0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::size_t count = benchmark::arg_or(argc, argv, 10000000);
+  using spsc = ouroboros::spsc_cyclic_queue<std::uint64_t>;
+  using locked = benchmark::locked_cyclic_deque<std::uint64_t>;
+
+  std::cout << "items: " << count
+            << ", hardware threads: " << std::thread::hardware_concurrency()
+            << std::endl;
+  benchmark::report(
+      "throughput spsc_cyclic_queue", Throughput<spsc>(count), count);
+  benchmark::report(
+      "throughput spsc_cyclic_queue batched", ThroughputBatched(count), count);
+  benchmark::report(
+      "throughput mutex + cyclic_deque", Throughput<locked>(count), count);
+
+  if (std::thread::hardware_concurrency() > 1) {
+    std::size_t round_trips = count / 10;
+    benchmark::report(
+        "handoff spsc_cyclic_queue", PingPong<spsc>(round_trips), round_trips);
+    benchmark::report(
+        "handoff mutex + cyclic_deque",
+        PingPong<locked>(round_trips),
+        round_trips);
+  } else {
+    std::cout << "handoff: skipped, requires two hardware threads"
+              << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,85 @@
+#include <benchmark.hpp>
+#include <cmath>
+#include <cstdint>
+#include <ouroboros/thread_pool.hpp>
+#include <vector>
+
+// Measures the scaling of the work-stealing thread pool on fine-grained tasks,
+// from 1 up to the number of hardware threads. A parallel_for over a vector
+// with a small grain and a recursive fork/join Fibonacci without a sequential
+// cutoff are compared to their serial versions.
+
+namespace {
+
+std::uint64_t SerialFib(int n) {
+  return n < 2 ? static_cast<std::uint64_t>(n)
+               : SerialFib(n - 1) + SerialFib(n - 2);
+}
+
+std::uint64_t Fib(ouroboros::thread_pool& pool, int n) {
+  if (n < 2) {
+    return static_cast<std::uint64_t>(n);
+  }
+  std::uint64_t a, b;
+  pool.fork_join(
+      [&]() { a = Fib(pool, n - 1); }, [&]() { b = Fib(pool, n - 2); });
+  return a + b;
+}
+
+void Work(std::vector<double>& v, std::size_t i) {
+  v[i] = std::sqrt(v[i] + static_cast<double>(i));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::size_t count = benchmark::arg_or(argc, argv, 4000000);
+  constexpr std::size_t kGrain = 256;
+  constexpr int kFib = 27;
+  double fib_ops = static_cast<double>(SerialFib(kFib));
+  std::vector<double> v(count, 1.0);
+
+  std::cout << "items: " << count << ", grain: " << kGrain << ", fib: " << kFib
+            << ", hardware threads: " << std::thread::hardware_concurrency()
+            << std::endl;
+
+  auto begin = benchmark::clock::now();
+  for (std::size_t i = 0; i < count; ++i) {
+    Work(v, i);
+  }
+  benchmark::do_not_optimize(v.data());
+  benchmark::report(
+      "parallel_for serial", benchmark::seconds(begin, benchmark::clock::now()),
+      static_cast<double>(count));
+
+  begin = benchmark::clock::now();
+  benchmark::do_not_optimize(SerialFib(kFib));
+  benchmark::report(
+      "fork_join fib serial",
+      benchmark::seconds(begin, benchmark::clock::now()), fib_ops);
+
+  std::size_t max_threads =
+      std::max(1u, std::thread::hardware_concurrency());
+  for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+    ouroboros::thread_pool pool(threads);
+    std::string suffix = " " + std::to_string(threads) + "T";
+
+    begin = benchmark::clock::now();
+    pool.parallel_for(std::size_t{0}, count, kGrain, [&v](std::size_t i) {
+      Work(v, i);
+    });
+    benchmark::do_not_optimize(v.data());
+    benchmark::report(
+        "parallel_for" + suffix,
+        benchmark::seconds(begin, benchmark::clock::now()),
+        static_cast<double>(count));
+
+    begin = benchmark::clock::now();
+    benchmark::do_not_optimize(Fib(pool, kFib));
+    benchmark::report(
+        "fork_join fib" + suffix,
+        benchmark::seconds(begin, benchmark::clock::now()), fib_ops);
+  }
+
+  return 0;
+}
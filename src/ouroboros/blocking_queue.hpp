@@ -0,0 +1,126 @@
+#pragma once
+
+#include <chrono>
+#include <utility>
+
+#include "wait_strategy.hpp"
+
+namespace ouroboros {
+
+//! \brief Adds blocking push() and pop() operations to one of the concurrent
+//! queues: spsc_cyclic_queue, mpsc_cyclic_queue or mpmc_cyclic_queue.
+//! \details The WaitStrategy_ decides how a thread waits when the queue is
+//! full or empty: spin_wait, yield_wait or futex_wait. Producers and consumers
+//! wait on separate instances of the strategy, so a push only wakes consumers
+//! and a pop only wakes producers. The roles of the wrapped queue still apply:
+//! a spsc_cyclic_queue allows a single producer and a single consumer.
+//!
+//! The statistics policy of the wrapped queue also records the time spent in
+//! push(), pop() and pop_for() waiting for the queue, and how often threads
+//! park and unpark. See contention_stats.
+template <typename Queue_, typename WaitStrategy_ = yield_wait>
+class blocking_queue {
+ public:
+  using queue_type = Queue_;
+  using wait_strategy_type = WaitStrategy_;
+  using stats_type = typename Queue_::stats_type;
+  using size_type = typename Queue_::size_type;
+  using value_type = typename Queue_::value_type;
+
+  //! \brief Create the wrapped queue from \p args.
+  template <typename... Args_>
+  explicit blocking_queue(Args_&&... args)
+      : queue_(std::forward<Args_>(args)...) {}
+
+  blocking_queue(blocking_queue const&) = delete;
+
+  blocking_queue& operator=(blocking_queue const&) = delete;
+
+  //! \brief Add an element to the end of the queue. Waits while the queue is
+  //! full.
+  void push(value_type value) {
+    if (!queue_.try_push(std::move(value))) {
+      auto start = stats().wait_start();
+      not_full_.wait(
+          [&]() { return queue_.try_push(std::move(value)); }, stats());
+      stats().wait_stop(start);
+    }
+    not_empty_.notify(stats());
+  }
+
+  //! \brief Add an element to the end of the queue. Returns false if the queue
+  //! is full.
+  template <typename U_>
+  bool try_push(U_&& value) {
+    if (!queue_.try_push(std::forward<U_>(value))) {
+      return false;
+    }
+    not_empty_.notify(stats());
+    return true;
+  }
+
+  //! \brief Remove the first element of the queue and move it into \p value.
+  //! Waits while the queue is empty.
+  void pop(value_type& value) {
+    if (!queue_.try_pop(value)) {
+      auto start = stats().wait_start();
+      not_empty_.wait([&]() { return queue_.try_pop(value); }, stats());
+      stats().wait_stop(start);
+    }
+    not_full_.notify(stats());
+  }
+
+  //! \brief Remove the first element of the queue and move it into \p value.
+  //! Waits at most \p timeout while the queue is empty. Returns false if the
+  //! timeout expired.
+  template <typename Rep_, typename Period_>
+  bool pop_for(
+      value_type& value, std::chrono::duration<Rep_, Period_> const& timeout) {
+    if (!queue_.try_pop(value)) {
+      auto deadline = WaitStrategy_::clock::now() +
+                      std::chrono::duration_cast<
+                          typename WaitStrategy_::clock::duration>(timeout);
+      auto start = stats().wait_start();
+      bool ready = not_empty_.wait_until(
+          [&]() { return queue_.try_pop(value); }, deadline, stats());
+      stats().wait_stop(start);
+      if (!ready) {
+        return false;
+      }
+    }
+    not_full_.notify(stats());
+    return true;
+  }
+
+  //! \brief Remove the first element of the queue and move it into \p value.
+  //! Returns false if the queue is empty.
+  bool try_pop(value_type& value) {
+    if (!queue_.try_pop(value)) {
+      return false;
+    }
+    not_full_.notify(stats());
+    return true;
+  }
+
+  //! \brief Return the maximum number of elements the queue can hold.
+  size_type capacity() const noexcept { return queue_.capacity(); }
+
+  //! \brief Return the approximate number of elements in the queue.
+  size_type size() const noexcept { return queue_.size(); }
+
+  //! \brief Return true if the queue is approximately empty.
+  bool empty() const noexcept { return queue_.empty(); }
+
+  //! \brief Return the statistics policy of the wrapped queue.
+  stats_type& stats() noexcept { return queue_.stats(); }
+
+  //! \brief Return the statistics policy of the wrapped queue.
+  stats_type const& stats() const noexcept { return queue_.stats(); }
+
+ private:
+  Queue_ queue_;
+  WaitStrategy_ not_empty_;
+  WaitStrategy_ not_full_;
+};
+
+}  // namespace ouroboros
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "concurrency.hpp"
+
+namespace ouroboros {
+
+//! \brief The result of broadcast_ring::reader::try_read().
+enum class read_status {
+  //! \brief An element was read.
+  ok,
+  //! \brief The reader has caught up with the writer. Nothing was read.
+  empty,
+  //! \brief The writer overwrote the element before it was read. The reader
+  //! skipped ahead to the oldest element that is still available. Nothing was
+  //! read.
+  lapped
+};
+
+//! \brief A single-writer ring that is read by any number of independent
+//! readers. The writer never waits for readers and overwrites the oldest
+//! element when the ring is full.
+//! \details Each slot is guarded by a seqlock: the writer makes the version
+//! of a slot odd while it writes the element and even once it is done. A
+//! reader copies the element and checks that the version still equals the one
+//! expected for its position. When it doesn't, the slot was overwritten and
+//! the reader was lapped. Readers don't register with the ring, so memory
+//! usage is independent of the number of readers.
+//!
+//! The value_type must be trivially copyable because readers may copy an
+//! element while it is being overwritten, in which case the copy is discarded.
+//! The capacity is rounded up to a power of two.
+template <typename T_, typename Allocator_ = std::allocator<T_>>
+class broadcast_ring {
+  static_assert(
+      std::is_trivially_copyable_v<T_>,
+      "ouroboros::broadcast_ring requires a trivially copyable value_type");
+
+  using slot = internal::seqlock_slot<T_>;
+  using slot_allocator =
+      typename std::allocator_traits<Allocator_>::template rebind_alloc<slot>;
+  using container = std::vector<slot, slot_allocator>;
+
+ public:
+  using allocator_type = Allocator_;
+  using size_type = std::size_t;
+  using value_type = T_;
+
+  //! \brief An independent cursor into a broadcast_ring. A reader is used by
+  //! a single thread.
+  class reader {
+   public:
+    //! \brief Copy the next element into \p value.
+    read_status try_read(value_type& value) noexcept {
+      std::uint64_t tail = ring_->tail_.load(std::memory_order_acquire);
+      if (position_ >= tail) {
+        return read_status::empty;
+      }
+
+      if (ring_->slots_[position_ & ring_->mask_].load(position_, value)) {
+        ++position_;
+        return read_status::ok;
+      }
+
+      resync();
+      return read_status::lapped;
+    }
+
+    //! \brief Return the total number of elements that were skipped because
+    //! the reader was lapped.
+    std::uint64_t missed() const noexcept { return missed_; }
+
+    //! \brief Return the number of elements the reader is behind the writer.
+    //! Can exceed the capacity when the reader was lapped.
+    std::uint64_t lag() const noexcept {
+      return ring_->tail_.load(std::memory_order_acquire) - position_;
+    }
+
+   private:
+    friend class broadcast_ring;
+
+    reader(broadcast_ring const* ring, std::uint64_t position) noexcept
+        : ring_(ring), position_(position), missed_(0) {}
+
+    //! \brief Skip ahead to the oldest element that the writer won't overwrite
+    //! with its next write.
+    void resync() noexcept {
+      std::uint64_t oldest =
+          ring_->oldest(ring_->tail_.load(std::memory_order_acquire));
+      if (position_ < oldest) {
+        missed_ += oldest - position_;
+        position_ = oldest;
+      }
+    }
+
+    broadcast_ring const* ring_;
+    std::uint64_t position_;
+    std::uint64_t missed_;
+  };
+
+  //! \brief Create a ring with at least \p c slots.
+  explicit broadcast_ring(
+      size_type c, allocator_type const& a = allocator_type())
+      : slots_(internal::ceil_power_of_two(c), slot_allocator(a)),
+        mask_(slots_.size() - 1),
+        tail_(0) {}
+
+  broadcast_ring(broadcast_ring const&) = delete;
+
+  broadcast_ring& operator=(broadcast_ring const&) = delete;
+
+  //! \brief Write an element, overwriting the oldest one if the ring is full.
+  //! Writer only.
+  void push(value_type const& value) noexcept {
+    std::uint64_t pos = tail_.load(std::memory_order_relaxed);
+    slots_[pos & mask_].store(pos, value);
+    tail_.store(pos + 1, std::memory_order_release);
+  }
+
+  //! \brief Return a reader that starts at the next element to be written.
+  reader make_reader() const noexcept {
+    return reader(this, tail_.load(std::memory_order_acquire));
+  }
+
+  //! \brief Return a reader that starts at the oldest element that the writer
+  //! won't overwrite with its next write.
+  reader make_reader_from_oldest() const noexcept {
+    return reader(this, oldest(tail_.load(std::memory_order_acquire)));
+  }
+
+  //! \brief Return the number of slots.
+  size_type capacity() const noexcept { return slots_.size(); }
+
+  //! \brief Return the total number of elements written.
+  std::uint64_t written() const noexcept {
+    return tail_.load(std::memory_order_acquire);
+  }
+
+ private:
+  //! \brief Return the position of the oldest element that the writer won't
+  //! overwrite with its next write, given that \p tail elements were written.
+  std::uint64_t oldest(std::uint64_t tail) const noexcept {
+    return tail >= capacity() ? tail - capacity() + 1 : 0;
+  }
+
+  // Shared and read-only after construction.
+  alignas(internal::cache_line_size) container slots_;
+  size_type mask_;
+  // Written by the writer.
+  alignas(internal::cache_line_size) std::atomic<std::uint64_t> tail_;
+};
+
+}  // namespace ouroboros
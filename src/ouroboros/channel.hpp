@@ -0,0 +1,347 @@
+#pragma once
+
+#if !defined(__cpp_impl_coroutine)
+#error "ouroboros/channel.hpp requires C++20 coroutines"
+#endif
+
+#include <algorithm>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "cyclic_deque.hpp"
+
+namespace ouroboros {
+
+namespace internal {
+
+//! \brief A FIFO queue of nodes that are linked through their next member.
+//! The queue doesn't own the nodes.
+template <typename Node_>
+class intrusive_queue {
+ public:
+  bool empty() const noexcept { return head_ == nullptr; }
+
+  void push(Node_* node) noexcept {
+    node->next = nullptr;
+    if (tail_ == nullptr) {
+      head_ = node;
+    } else {
+      tail_->next = node;
+    }
+    tail_ = node;
+  }
+
+  Node_* pop() noexcept {
+    Node_* node = head_;
+    head_ = node->next;
+    if (head_ == nullptr) {
+      tail_ = nullptr;
+    }
+    return node;
+  }
+
+ private:
+  Node_* head_ = nullptr;
+  Node_* tail_ = nullptr;
+};
+
+}  // namespace internal
+
+//! \brief The return type of a coroutine that is started by an executor and
+//! destroys itself when it finishes.
+class detached_task {
+ public:
+  struct promise_type {
+    detached_task get_return_object() noexcept {
+      return detached_task(
+          std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    std::suspend_never final_suspend() noexcept { return {}; }
+
+    void return_void() noexcept {}
+
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+
+  detached_task(detached_task&& other) noexcept
+      : handle_(std::exchange(other.handle_, nullptr)) {}
+
+  detached_task(detached_task const&) = delete;
+
+  detached_task& operator=(detached_task const&) = delete;
+
+  //! \brief Destroy the coroutine if it was never started.
+  ~detached_task() {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+  //! \brief Release ownership of the coroutine.
+  std::coroutine_handle<> release() noexcept {
+    return std::exchange(handle_, nullptr);
+  }
+
+ private:
+  explicit detached_task(std::coroutine_handle<> handle) noexcept
+      : handle_(handle) {}
+
+  std::coroutine_handle<> handle_;
+};
+
+//! \brief A minimal single-threaded executor that resumes coroutines in FIFO
+//! order.
+//! \details Ready coroutines are kept in a cyclic_deque that doubles its
+//! capacity when it is full. Coroutines are only resumed from run() or
+//! run_one(), never from within schedule().
+class executor {
+  using handle_queue = cyclic_deque<std::coroutine_handle<>>;
+
+ public:
+  using size_type = handle_queue::size_type;
+
+  //! \brief Create an executor with room for \p c ready coroutines before the
+  //! ready queue has to grow.
+  explicit executor(size_type c = 64) : ready_(std::max<size_type>(c, 1)) {}
+
+  executor(executor const&) = delete;
+
+  executor& operator=(executor const&) = delete;
+
+  //! \brief Start the coroutine of \p t on the next call to run().
+  void spawn(detached_task t) { schedule(t.release()); }
+
+  //! \brief Resume \p h on the next call to run().
+  void schedule(std::coroutine_handle<> h) {
+    if (ready_.full()) {
+      handle_queue grown(ready_.capacity() * 2);
+      for (auto r : ready_) {
+        grown.push_back(r);
+      }
+      ready_ = std::move(grown);
+    }
+    ready_.push_back(h);
+  }
+
+  //! \brief Resume a single ready coroutine. Returns false if there was none.
+  bool run_one() {
+    if (ready_.empty()) {
+      return false;
+    }
+    std::coroutine_handle<> h = ready_.front();
+    ready_.pop_front();
+    h.resume();
+    return true;
+  }
+
+  //! \brief Resume ready coroutines until there are none left. Returns the
+  //! number of coroutines resumed.
+  size_type run() {
+    size_type n = 0;
+    while (run_one()) {
+      ++n;
+    }
+    return n;
+  }
+
+  //! \brief Return true if no coroutine is ready to be resumed.
+  bool empty() const noexcept { return ready_.empty(); }
+
+ private:
+  handle_queue ready_;
+};
+
+//! \brief A bounded, single-threaded channel for coroutines, backed by a
+//! cyclic_deque.
+//! \details `co_await ch.push(v)` suspends while the channel is full and
+//! `co_await ch.pop()` suspends while it is empty. Suspended coroutines are
+//! queued in FIFO order inside their own awaiter objects, and are resumed
+//! through the executor of the channel. When space or data is available,
+//! neither operation suspends nor allocates.
+//!
+//! After close(), push() fails and pop() returns the remaining elements
+//! followed by std::nullopt. All coroutines using a channel must run on its
+//! executor.
+template <typename T_, typename Allocator_ = std::allocator<T_>>
+class channel {
+  using buffer = cyclic_deque<T_, Allocator_>;
+
+ public:
+  using allocator_type = typename buffer::allocator_type;
+  using size_type = typename buffer::size_type;
+  using value_type = T_;
+
+  //! \brief The awaiter returned by push(). Resumes with true once the value
+  //! was added, or with false when the channel was closed.
+  class push_awaiter {
+   public:
+    bool await_ready() {
+      if (channel_->closed_) {
+        ok_ = false;
+        return true;
+      }
+      return channel_->try_push(std::move(value_));
+    }
+
+    void await_suspend(std::coroutine_handle<> h) noexcept {
+      handle_ = h;
+      channel_->pushers_.push(this);
+    }
+
+    bool await_resume() const noexcept { return ok_; }
+
+   private:
+    friend class channel;
+    friend class internal::intrusive_queue<push_awaiter>;
+
+    push_awaiter(channel* c, value_type value)
+        : channel_(c), value_(std::move(value)) {}
+
+    channel* channel_;
+    value_type value_;
+    bool ok_ = true;
+    std::coroutine_handle<> handle_;
+    push_awaiter* next = nullptr;
+  };
+
+  //! \brief The awaiter returned by pop(). Resumes with the first element, or
+  //! with std::nullopt when the channel is closed and empty.
+  class pop_awaiter {
+   public:
+    bool await_ready() {
+      return channel_->try_pop(value_) || channel_->closed_;
+    }
+
+    void await_suspend(std::coroutine_handle<> h) noexcept {
+      handle_ = h;
+      channel_->poppers_.push(this);
+    }
+
+    std::optional<value_type> await_resume() noexcept(
+        std::is_nothrow_move_constructible_v<value_type>) {
+      return std::move(value_);
+    }
+
+   private:
+    friend class channel;
+    friend class internal::intrusive_queue<pop_awaiter>;
+
+    explicit pop_awaiter(channel* c) noexcept : channel_(c) {}
+
+    channel* channel_;
+    std::optional<value_type> value_;
+    std::coroutine_handle<> handle_;
+    pop_awaiter* next = nullptr;
+  };
+
+  //! \brief Create a channel that buffers up to \p c elements. A channel with
+  //! a capacity of zero hands each element directly from push to pop.
+  channel(
+      executor& e, size_type c, allocator_type const& a = allocator_type())
+      : executor_(&e), buf_(c, a), closed_(false) {}
+
+  channel(channel const&) = delete;
+
+  channel& operator=(channel const&) = delete;
+
+  //! \brief Return an awaiter that adds \p value to the end of the channel.
+  push_awaiter push(value_type value) {
+    return push_awaiter(this, std::move(value));
+  }
+
+  //! \brief Return an awaiter that removes the first element of the channel.
+  pop_awaiter pop() noexcept { return pop_awaiter(this); }
+
+  //! \brief Add \p value to the end of the channel without suspending.
+  //! Returns false if the channel is full or closed. \p value is only moved
+  //! from on success.
+  template <typename U_>
+  bool try_push(U_&& value) {
+    if (closed_) {
+      return false;
+    }
+    if (!poppers_.empty()) {
+      // Only possible when the buffer is empty.
+      pop_awaiter* p = poppers_.pop();
+      p->value_.emplace(std::forward<U_>(value));
+      executor_->schedule(p->handle_);
+      return true;
+    }
+    if (buf_.full()) {
+      return false;
+    }
+    buf_.push_back(std::forward<U_>(value));
+    return true;
+  }
+
+  //! \brief Remove the first element of the channel without suspending.
+  //! Returns std::nullopt if the channel is empty.
+  std::optional<value_type> try_pop() {
+    std::optional<value_type> value;
+    try_pop(value);
+    return value;
+  }
+
+  //! \brief Close the channel and resume all suspended coroutines. Elements
+  //! that are still buffered can be popped.
+  void close() {
+    closed_ = true;
+    while (!pushers_.empty()) {
+      push_awaiter* p = pushers_.pop();
+      p->ok_ = false;
+      executor_->schedule(p->handle_);
+    }
+    while (!poppers_.empty()) {
+      executor_->schedule(poppers_.pop()->handle_);
+    }
+  }
+
+  //! \brief Return true if the channel was closed.
+  bool closed() const noexcept { return closed_; }
+
+  //! \brief Return the number of buffered elements.
+  size_type size() const noexcept { return buf_.size(); }
+
+  //! \brief Return the maximum number of buffered elements.
+  size_type capacity() const noexcept { return buf_.capacity(); }
+
+  //! \brief Return true if no elements are buffered.
+  bool empty() const noexcept { return buf_.empty(); }
+
+ private:
+  bool try_pop(std::optional<value_type>& value) {
+    if (!buf_.empty()) {
+      value.emplace(std::move(buf_.front()));
+      buf_.pop_front();
+      if (!pushers_.empty()) {
+        // Move the value of the first suspended pusher into the freed slot.
+        push_awaiter* p = pushers_.pop();
+        buf_.push_back(std::move(p->value_));
+        executor_->schedule(p->handle_);
+      }
+      return true;
+    }
+    if (!pushers_.empty()) {
+      // Only possible for a channel with a capacity of zero.
+      push_awaiter* p = pushers_.pop();
+      value.emplace(std::move(p->value_));
+      executor_->schedule(p->handle_);
+      return true;
+    }
+    return false;
+  }
+
+  executor* executor_;
+  buffer buf_;
+  bool closed_;
+  internal::intrusive_queue<push_awaiter> pushers_;
+  internal::intrusive_queue<pop_awaiter> poppers_;
+};
+
+}  // namespace ouroboros
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+    defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+namespace ouroboros {
+
+namespace internal {
+
+//! \brief The assumed size of a cache line. Data that is written by different
+//! threads is aligned to this size to prevent false sharing.
+//! \details std::hardware_destructive_interference_size is not used because its
+//! value may differ between compilers and compiler flags, making it unsuitable
+//! for a header only library.
+inline constexpr std::size_t cache_line_size = 64;
+
+//! \brief Return the smallest power of two that is larger than or equal to
+//! \p n, with a minimum of 1.
+template <typename Size_>
+constexpr Size_ ceil_power_of_two(Size_ n) noexcept {
+  Size_ p = 1;
+  while (p < n) {
+    p <<= 1;
+  }
+  return p;
+}
+
+//! \brief Hint to the processor that the calling thread is busy-waiting. This
+//! lowers power usage and frees resources for a sibling hyper-thread.
+inline void cpu_relax() noexcept {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || \
+    defined(_M_IX86)
+  _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  asm volatile("yield" ::: "memory");
+#endif
+}
+
+//! \brief A slot of a single-writer ring that holds the element at a position,
+//! guarded by a seqlock. The version is odd while the writer writes the element
+//! at position p and equals 2 * p + 2 once it is done.
+//! \details A reader may copy the element while it is being overwritten, in
+//! which case the copy is discarded. T_ must therefore be trivially copyable.
+template <typename T_>
+struct seqlock_slot {
+  //! \brief Write \p v as the element at \p position. Writer only.
+  void store(std::uint64_t position, T_ const& v) noexcept {
+    version.store(2 * position + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(
+        static_cast<void*>(&value), static_cast<void const*>(&v), sizeof(T_));
+    version.store(2 * position + 2, std::memory_order_release);
+  }
+
+  //! \brief Copy the element at \p position into \p v. Returns false if the
+  //! slot doesn't hold that element, or if it was overwritten during the copy.
+  bool load(std::uint64_t position, T_& v) const noexcept {
+    std::uint64_t expected = 2 * position + 2;
+    if (version.load(std::memory_order_acquire) != expected) {
+      return false;
+    }
+    std::memcpy(
+        static_cast<void*>(&v), static_cast<void const*>(&value), sizeof(T_));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version.load(std::memory_order_relaxed) == expected;
+  }
+
+  std::atomic<std::uint64_t> version{0};
+  T_ value;
+};
+
+//! \brief Add \p n to a counter that is only written by the calling thread.
+//! A relaxed load and store is enough and avoids a read-modify-write.
+inline void single_writer_increment(
+    std::atomic<std::uint64_t>& counter, std::uint64_t n = 1) noexcept {
+  counter.store(
+      counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+//! \brief Destroy the record \p r owned by \p records. The order of the other
+//! records isn't kept.
+//! \details Undefined behavior if \p records doesn't own \p r.
+template <typename Record_, typename Deleter_, typename Allocator_>
+void erase_record(
+    std::vector<std::unique_ptr<Record_, Deleter_>, Allocator_>& records,
+    Record_ const& r) noexcept {
+  auto it = records.begin();
+  while (it->get() != &r) {
+    ++it;
+  }
+  std::swap(*it, records.back());
+  records.pop_back();
+}
+
+//! \brief The action of a thread_local_registry for the records of an exiting
+//! thread that does nothing.
+struct ignore_thread_exit {
+  template <typename Owner_, typename Record_>
+  void operator()(Owner_&, Record_&) const noexcept {}
+};
+
+//! \brief Finds the record of the calling thread for one instance of a class,
+//! such as the per-thread counters of a contention_stats.
+//! \details Each registry reserves a slot, which is reused once the registry
+//! is destroyed, and a unique id. Each thread keeps a table of entries indexed
+//! by slot, which makes a lookup O(1). An entry with a different id belongs to
+//! a destroyed registry. The entries of destroyed owners are dropped whenever
+//! the calling thread adds an entry, such that a thread never keeps more
+//! entries than there are registries.
+//!
+//! The records are owned by an instance of Owner_, which must outlive the
+//! registry. When a thread exits, it calls Exit_()(owner, record) for each of
+//! its records of which the owner still exists, keeping the owner alive in the
+//! meantime. Exit_ may destroy the record.
+template <
+    typename Owner_,
+    typename Record_,
+    typename Exit_ = ignore_thread_exit>
+class thread_local_registry {
+ public:
+  thread_local_registry() : slot_(acquire_slot()), id_(next_id()) {}
+
+  thread_local_registry(thread_local_registry const&) = delete;
+
+  thread_local_registry& operator=(thread_local_registry const&) = delete;
+
+  ~thread_local_registry() { release_slot(slot_); }
+
+  //! \brief Return the record of the calling thread. The first time, the
+  //! record is created by calling \p make(), which returns a pointer to a
+  //! record owned by \p owner.
+  //! \details Undefined behavior if \p owner differs between calls.
+  template <typename Make_>
+  Record_& local(std::shared_ptr<Owner_> const& owner, Make_&& make) {
+    auto& entries = table().entries;
+    if (slot_ < entries.size() && entries[slot_].id == id_) {
+      return *entries[slot_].record;
+    }
+    Record_* record = make();
+    for (auto& e : entries) {
+      if (e.record != nullptr && e.owner.expired()) {
+        e = entry();
+      }
+    }
+    if (entries.size() <= slot_) {
+      entries.resize(slot_ + 1);
+    }
+    entries[slot_] = entry{id_, owner, record};
+    return *record;
+  }
+
+ private:
+  struct entry {
+    std::uint64_t id = 0;
+    std::weak_ptr<Owner_> owner;
+    Record_* record = nullptr;
+  };
+
+  struct local_table {
+    ~local_table() {
+      for (auto& e : entries) {
+        if (auto owner = e.owner.lock()) {
+          Exit_()(*owner, *e.record);
+        }
+      }
+    }
+
+    std::vector<entry> entries;
+  };
+
+  struct slot_pool {
+    std::mutex mutex;
+    std::vector<std::size_t> free;
+    std::size_t next = 0;
+  };
+
+  static local_table& table() {
+    static thread_local local_table t;
+    return t;
+  }
+
+  static slot_pool& slots() {
+    static slot_pool p;
+    return p;
+  }
+
+  static std::size_t acquire_slot() {
+    slot_pool& p = slots();
+    std::lock_guard<std::mutex> lock(p.mutex);
+    if (p.free.empty()) {
+      return p.next++;
+    }
+    std::size_t s = p.free.back();
+    p.free.pop_back();
+    return s;
+  }
+
+  static void release_slot(std::size_t s) {
+    slot_pool& p = slots();
+    std::lock_guard<std::mutex> lock(p.mutex);
+    p.free.push_back(s);
+  }
+
+  //! \brief Return a unique id for each registry, such that the entries of a
+  //! destroyed registry can never match a new one that reuses its slot. Zero
+  //! marks an unused entry.
+  static std::uint64_t next_id() noexcept {
+    static std::atomic<std::uint64_t> id{0};
+    return id.fetch_add(1, std::memory_order_relaxed) + 1;
+  }
+
+  std::size_t const slot_;
+  std::uint64_t const id_;
+};
+
+}  // namespace internal
+
+}  // namespace ouroboros
@@ -0,0 +1,281 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+#include "concurrency.hpp"
+#include "cyclic_deque.hpp"
+
+namespace ouroboros {
+
+//! \brief A bounded, thread-safe double-ended queue with separate locks for
+//! its front and back.
+//! \details Operations at the front only take the front lock and operations at
+//! the back only take the back lock, such that both ends can be used
+//! concurrently. Two counters keep the ends apart: the number of published
+//! elements, which a pop claims from, and the number of reserved slots, which
+//! a push claims from. A pop only takes its fast path when at least one
+//! element remains for the other end, and a push only when a free slot is left
+//! for it. Otherwise, when the deque is nearly empty or nearly full, the
+//! operation takes both locks and runs exclusively.
+//!
+//! The bulk operations claim, write and publish a batch of elements while
+//! taking each lock once per batch. If assigning an element throws, the
+//! elements transferred before it stay transferred and the others stay where
+//! they were, such that the deque remains consistent.
+template <typename T_, typename Allocator_ = std::allocator<T_>>
+class concurrent_cyclic_deque {
+  static_assert(
+      std::is_same_v<std::remove_cv_t<T_>, T_>,
+      "ouroboros::concurrent_cyclic_deque must have a non-const, non-volatile "
+      "value_type");
+
+  using container = std::vector<T_, Allocator_>;
+
+ public:
+  using allocator_type = typename container::allocator_type;
+  using size_type = typename container::size_type;
+  using value_type = typename container::value_type;
+  using reference = typename container::reference;
+  using const_reference = typename container::const_reference;
+
+  //! \brief Create a deque that can hold \p c elements.
+  explicit concurrent_cyclic_deque(
+      size_type c, allocator_type const& a = allocator_type())
+      : buf_(c, a), front_(0), back_(0), size_(0), reserved_(0) {}
+
+  concurrent_cyclic_deque(concurrent_cyclic_deque const&) = delete;
+
+  concurrent_cyclic_deque& operator=(concurrent_cyclic_deque const&) = delete;
+
+  //! \brief Add an element to the end of the deque. Returns false if the deque
+  //! is full.
+  template <typename U_>
+  bool try_push_back(U_&& value) {
+    return try_push_back_n(&value, 1, [](auto* v) -> U_&& {
+      return std::forward<U_>(*v);
+    }) == 1;
+  }
+
+  //! \brief Add an element to the beginning of the deque. Returns false if the
+  //! deque is full.
+  template <typename U_>
+  bool try_push_front(U_&& value) {
+    return try_push_front_n(&value, 1, [](auto* v) -> U_&& {
+      return std::forward<U_>(*v);
+    }) == 1;
+  }
+
+  //! \brief Remove the first element and move it into \p value. Returns false
+  //! if the deque is empty.
+  bool try_pop_front(value_type& value) {
+    return try_pop_front_n(&value, 1) == 1;
+  }
+
+  //! \brief Remove the last element and move it into \p value. Returns false
+  //! if the deque is empty.
+  bool try_pop_back(value_type& value) {
+    return try_pop_back_n(&value, 1) == 1;
+  }
+
+  //! \brief Add up to \p n elements, read from \p first, to the end of the
+  //! deque, in order. Returns the number of elements added.
+  template <typename InputIterator_>
+  size_type try_push_back_n(InputIterator_ first, size_type n) {
+    return try_push_back_n(first, n, [](InputIterator_ it) -> decltype(auto) {
+      return *it;
+    });
+  }
+
+  //! \brief Add up to \p n elements, read from \p first, to the beginning of
+  //! the deque one at a time, as if by repeated push_front. The last element
+  //! read becomes the first element of the deque. Returns the number of
+  //! elements added.
+  template <typename InputIterator_>
+  size_type try_push_front_n(InputIterator_ first, size_type n) {
+    return try_push_front_n(first, n, [](InputIterator_ it) -> decltype(auto) {
+      return *it;
+    });
+  }
+
+  //! \brief Remove up to \p n elements from the beginning of the deque and
+  //! move them to \p out, in order. Returns the number of elements removed.
+  template <typename OutputIterator_>
+  size_type try_pop_front_n(OutputIterator_ out, size_type n) {
+    return pop_n(
+        front_mutex_, n, [this, &out](size_type k, size_type& done) {
+          for (; done < k; ++done, ++out) {
+            *out = std::move(buf_[front_]);
+            front_ = inc(front_);
+          }
+        });
+  }
+
+  //! \brief Remove up to \p n elements from the end of the deque and move them
+  //! to \p out, last element first, as if by repeated pop_back. Returns the
+  //! number of elements removed.
+  template <typename OutputIterator_>
+  size_type try_pop_back_n(OutputIterator_ out, size_type n) {
+    return pop_n(
+        back_mutex_, n, [this, &out](size_type k, size_type& done) {
+          for (; done < k; ++done, ++out) {
+            size_type i = dec(back_);
+            *out = std::move(buf_[i]);
+            back_ = i;
+          }
+        });
+  }
+
+  //! \brief Return the maximum number of elements the deque can hold.
+  size_type capacity() const noexcept { return buf_.size(); }
+
+  //! \brief Return the approximate number of elements in the deque.
+  size_type size() const noexcept {
+    return size_.load(std::memory_order_acquire);
+  }
+
+  //! \brief Return true if the deque is approximately empty.
+  bool empty() const noexcept { return size() == 0; }
+
+ private:
+  template <typename InputIterator_, typename Get_>
+  size_type try_push_back_n(InputIterator_ first, size_type n, Get_ get) {
+    return push_n(
+        back_mutex_, n, [this, &first, &get](size_type k, size_type& done) {
+          for (; done < k; ++done, ++first) {
+            buf_[back_] = get(first);
+            back_ = inc(back_);
+          }
+        });
+  }
+
+  template <typename InputIterator_, typename Get_>
+  size_type try_push_front_n(InputIterator_ first, size_type n, Get_ get) {
+    return push_n(
+        front_mutex_, n, [this, &first, &get](size_type k, size_type& done) {
+          for (; done < k; ++done, ++first) {
+            size_type i = dec(front_);
+            buf_[i] = get(first);
+            front_ = i;
+          }
+        });
+  }
+
+  //! \brief Reserve up to \p n free slots, call \p write(k, done) for the
+  //! number of slots reserved and publish the written elements.
+  //! \details \p write counts the elements it has written in \p done and only
+  //! moves the end of the deque past a slot once it holds its element. If
+  //! \p write throws, the elements written so far are published and the rest
+  //! of the reservation is released before the exception propagates.
+  template <typename Write_>
+  size_type push_n(std::mutex& end_mutex, size_type n, Write_&& write) {
+    if (n == 0) {
+      return 0;
+    }
+    {
+      std::lock_guard<std::mutex> lock(end_mutex);
+      // Fast path: the reservation keeps the slot apart from any concurrent
+      // push at the other end.
+      size_type r = reserved_.load(std::memory_order_relaxed);
+      while (r + n <= capacity()) {
+        if (reserved_.compare_exchange_weak(
+                r, r + n, std::memory_order_acq_rel)) {
+          return publish(n, write);
+        }
+      }
+    }
+    std::scoped_lock lock(front_mutex_, back_mutex_);
+    size_type k = std::min(n, capacity() - reserved_.load());
+    reserved_.fetch_add(k);
+    return publish(k, write);
+  }
+
+  //! \brief Call \p write(k, done) for \p k reserved slots and publish the
+  //! elements written.
+  template <typename Write_>
+  size_type publish(size_type k, Write_& write) {
+    size_type done = 0;
+    try {
+      write(k, done);
+    } catch (...) {
+      reserved_.fetch_sub(k - done, std::memory_order_acq_rel);
+      size_.fetch_add(done, std::memory_order_acq_rel);
+      throw;
+    }
+    size_.fetch_add(k, std::memory_order_acq_rel);
+    return k;
+  }
+
+  //! \brief Claim up to \p n published elements, call \p read(k, done) for
+  //! the number of elements claimed and release their slots.
+  //! \details \p read counts the elements it has read in \p done and only
+  //! moves the end of the deque past a slot once its element is read. If
+  //! \p read throws, the slots read so far are released and the unread
+  //! elements are published again before the exception propagates.
+  template <typename Read_>
+  size_type pop_n(std::mutex& end_mutex, size_type n, Read_&& read) {
+    if (n == 0) {
+      return 0;
+    }
+    {
+      std::lock_guard<std::mutex> lock(end_mutex);
+      // Fast path: leaving at least one element keeps the claimed elements
+      // apart from any concurrent pop at the other end.
+      size_type s = size_.load(std::memory_order_relaxed);
+      while (s > n) {
+        if (size_.compare_exchange_weak(
+                s, s - n, std::memory_order_acq_rel)) {
+          return release(n, read);
+        }
+      }
+    }
+    std::scoped_lock lock(front_mutex_, back_mutex_);
+    size_type k = std::min(n, size_.load());
+    size_.fetch_sub(k);
+    return release(k, read);
+  }
+
+  //! \brief Call \p read(k, done) for \p k claimed elements and release the
+  //! slots read.
+  template <typename Read_>
+  size_type release(size_type k, Read_& read) {
+    size_type done = 0;
+    try {
+      read(k, done);
+    } catch (...) {
+      size_.fetch_add(k - done, std::memory_order_acq_rel);
+      reserved_.fetch_sub(done, std::memory_order_acq_rel);
+      throw;
+    }
+    reserved_.fetch_sub(k, std::memory_order_acq_rel);
+    return k;
+  }
+
+  size_type inc(size_type i) const noexcept {
+    return internal::inc_cycle(i, size_type(0), capacity());
+  }
+
+  size_type dec(size_type i) const noexcept {
+    return internal::dec_cycle(i, size_type(0), capacity());
+  }
+
+  // Shared and read-only after construction.
+  alignas(internal::cache_line_size) container buf_;
+  // Guarded by the front lock.
+  alignas(internal::cache_line_size) std::mutex front_mutex_;
+  size_type front_;
+  // Guarded by the back lock.
+  alignas(internal::cache_line_size) std::mutex back_mutex_;
+  size_type back_;
+  // The number of published elements.
+  alignas(internal::cache_line_size) std::atomic<size_type> size_;
+  // The number of published elements plus slots that are being written or
+  // read.
+  std::atomic<size_type> reserved_;
+};
+
+}  // namespace ouroboros
@@ -0,0 +1,260 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "concurrency.hpp"
+
+namespace ouroboros {
+
+//! \brief Statistics policies select at compile time whether the concurrent
+//! queues record why their threads wait.
+//! \details Every statistics policy has the following interface:
+//! * cas_retry(): A compare-and-swap failed and the operation is retried.
+//! * full(): A producer found the queue full.
+//! * empty(): A consumer found the queue empty.
+//! * park(): A thread is about to sleep in the kernel.
+//! * unpark(): A thread wakes up sleeping threads.
+//! * wait_start(): Return a token that marks the start of a wait.
+//! * wait_stop(token): Record the time spent waiting since wait_start().
+//!
+//! A queue that retries an operation until it succeeds, such as
+//! blocking_queue::push(), calls full() or empty() for each failed attempt.
+
+//! \brief The default statistics policy, which records nothing. All of its
+//! methods are empty and wait_start() doesn't read the clock, such that a
+//! queue compiles to the same code as without statistics.
+class no_stats {
+ public:
+  struct token {};
+
+  static constexpr bool enabled = false;
+
+  void cas_retry() noexcept {}
+
+  void full() noexcept {}
+
+  void empty() noexcept {}
+
+  void park() noexcept {}
+
+  void unpark() noexcept {}
+
+  token wait_start() const noexcept { return {}; }
+
+  void wait_stop(token) noexcept {}
+};
+
+//! \brief A statistics policy that counts contention events and keeps a
+//! histogram of wait times.
+//! \details Each thread writes to a record of its own that is aligned to
+//! cache lines, such that recording an event never causes contention between
+//! threads. Records are found through thread-local storage and summed by
+//! collect(). When a thread exits, its counters are added to those of the
+//! statistics and its record is dropped, such that only running threads keep
+//! records.
+//!
+//! Like those of no_stats, the methods that record an event never throw, such
+//! that the policy doesn't change the exception guarantees of a queue. When
+//! the record of a thread can't be allocated, the event isn't recorded and the
+//! next event tries again.
+//!
+//! Wait times are counted in buckets of exponentially growing size. Bucket 0
+//! holds waits shorter than a nanosecond and bucket i holds waits within
+//! [2^(i-1), 2^i) nanoseconds. The last bucket also holds all longer waits.
+class contention_stats {
+ public:
+  using clock = std::chrono::steady_clock;
+  using token = clock::time_point;
+
+  static constexpr bool enabled = true;
+
+  //! \brief The number of buckets of the wait time histogram.
+  static constexpr std::size_t bucket_count = 32;
+
+  //! \brief Event counters summed over all threads. The values are
+  //! approximate while threads use the queue.
+  struct statistics {
+    //! \brief The number of failed compare-and-swap operations.
+    std::uint64_t cas_retries;
+    //! \brief The number of times a producer found the queue full.
+    std::uint64_t full;
+    //! \brief The number of times a consumer found the queue empty.
+    std::uint64_t empty;
+    //! \brief The number of times a thread went to sleep in the kernel.
+    std::uint64_t parks;
+    //! \brief The number of times a thread woke up sleeping threads.
+    std::uint64_t unparks;
+    //! \brief The number of waits.
+    std::uint64_t waits;
+    //! \brief The total time spent waiting.
+    std::chrono::nanoseconds wait_time;
+    //! \brief The number of waits per bucket.
+    std::array<std::uint64_t, bucket_count> wait_histogram;
+  };
+
+  contention_stats() : state_(std::make_shared<state>()) {}
+
+  contention_stats(contention_stats const&) = delete;
+
+  contention_stats& operator=(contention_stats const&) = delete;
+
+  void cas_retry() noexcept {
+    if (record* r = local_record()) {
+      internal::single_writer_increment(r->cas_retries);
+    }
+  }
+
+  void full() noexcept {
+    if (record* r = local_record()) {
+      internal::single_writer_increment(r->full);
+    }
+  }
+
+  void empty() noexcept {
+    if (record* r = local_record()) {
+      internal::single_writer_increment(r->empty);
+    }
+  }
+
+  void park() noexcept {
+    if (record* r = local_record()) {
+      internal::single_writer_increment(r->parks);
+    }
+  }
+
+  void unpark() noexcept {
+    if (record* r = local_record()) {
+      internal::single_writer_increment(r->unparks);
+    }
+  }
+
+  token wait_start() const noexcept { return clock::now(); }
+
+  void wait_stop(token start) noexcept {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                  clock::now() - start)
+                  .count();
+    auto n = static_cast<std::uint64_t>(ns > 0 ? ns : 0);
+    if (record* r = local_record()) {
+      internal::single_writer_increment(r->waits);
+      internal::single_writer_increment(r->wait_ns, n);
+      internal::single_writer_increment(r->wait_histogram[bucket(n)]);
+    }
+  }
+
+  //! \brief Return the counters, summed over all threads.
+  statistics collect() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    statistics s = state_->totals;
+    std::uint64_t wait_ns = state_->wait_ns;
+    for (auto const& r : state_->records) {
+      s.cas_retries += r->cas_retries.load(std::memory_order_relaxed);
+      s.full += r->full.load(std::memory_order_relaxed);
+      s.empty += r->empty.load(std::memory_order_relaxed);
+      s.parks += r->parks.load(std::memory_order_relaxed);
+      s.unparks += r->unparks.load(std::memory_order_relaxed);
+      s.waits += r->waits.load(std::memory_order_relaxed);
+      wait_ns += r->wait_ns.load(std::memory_order_relaxed);
+      for (std::size_t i = 0; i < bucket_count; ++i) {
+        s.wait_histogram[i] +=
+            r->wait_histogram[i].load(std::memory_order_relaxed);
+      }
+    }
+    s.wait_time = std::chrono::nanoseconds(wait_ns);
+    return s;
+  }
+
+  //! \brief Return the number of records, which is the number of running
+  //! threads that recorded an event.
+  std::size_t record_count() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->records.size();
+  }
+
+  //! \brief Return the index of the bucket for a wait of \p ns nanoseconds.
+  static constexpr std::size_t bucket(std::uint64_t ns) noexcept {
+    std::size_t i = 0;
+    while (ns > 0 && i + 1 < bucket_count) {
+      ns >>= 1;
+      ++i;
+    }
+    return i;
+  }
+
+  //! \brief Return the shortest wait that is counted in bucket \p i.
+  static constexpr std::chrono::nanoseconds bucket_floor(
+      std::size_t i) noexcept {
+    return std::chrono::nanoseconds(
+        i == 0 ? 0 : std::int64_t(1) << (i - 1));
+  }
+
+ private:
+  //! \brief The counters of a single thread. They are only written by their
+  //! thread.
+  struct alignas(internal::cache_line_size) record {
+    std::atomic<std::uint64_t> cas_retries{0};
+    std::atomic<std::uint64_t> full{0};
+    std::atomic<std::uint64_t> empty{0};
+    std::atomic<std::uint64_t> parks{0};
+    std::atomic<std::uint64_t> unparks{0};
+    std::atomic<std::uint64_t> waits{0};
+    std::atomic<std::uint64_t> wait_ns{0};
+    std::array<std::atomic<std::uint64_t>, bucket_count> wait_histogram{};
+  };
+
+  struct state {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<record>> records;
+    // The counters of the threads that exited, guarded by the mutex. The wait
+    // time is kept in wait_ns.
+    statistics totals{};
+    std::uint64_t wait_ns = 0;
+  };
+
+  //! \brief Adds the counters of an exiting thread to the totals and drops
+  //! its record.
+  struct fold_record {
+    void operator()(state& s, record& r) const {
+      std::lock_guard<std::mutex> lock(s.mutex);
+      s.totals.cas_retries += r.cas_retries.load(std::memory_order_relaxed);
+      s.totals.full += r.full.load(std::memory_order_relaxed);
+      s.totals.empty += r.empty.load(std::memory_order_relaxed);
+      s.totals.parks += r.parks.load(std::memory_order_relaxed);
+      s.totals.unparks += r.unparks.load(std::memory_order_relaxed);
+      s.totals.waits += r.waits.load(std::memory_order_relaxed);
+      s.wait_ns += r.wait_ns.load(std::memory_order_relaxed);
+      for (std::size_t i = 0; i < bucket_count; ++i) {
+        s.totals.wait_histogram[i] +=
+            r.wait_histogram[i].load(std::memory_order_relaxed);
+      }
+      internal::erase_record(s.records, r);
+    }
+  };
+
+  //! \brief Return the record of the calling thread, creating it the first
+  //! time. Returns nullptr if the record couldn't be created.
+  record* local_record() noexcept {
+    try {
+      return &registry_.local(state_, [this]() {
+        auto r = std::make_unique<record>();
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->records.push_back(std::move(r));
+        return state_->records.back().get();
+      });
+    } catch (...) {
+      return nullptr;
+    }
+  }
+
+  std::shared_ptr<state> state_;
+  internal::thread_local_registry<state, record, fold_record> registry_;
+};
+
+}  // namespace ouroboros
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cstddef>
 #include <initializer_list>
 #include <iterator>
 #include <memory>
@@ -11,6 +14,53 @@
 
 namespace ouroboros {
 
+//! \brief A contiguous range of elements [data()...data()+size()). Used to
+//! expose the at most two physical parts of the buffer of a cyclic_deque.
+template <typename T_>
+class segment {
+ public:
+  using element_type = T_;
+  using value_type = std::remove_cv_t<T_>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using pointer = T_*;
+  using reference = T_&;
+  using iterator = T_*;
+
+  constexpr segment() noexcept : data_(), size_() {}
+
+  constexpr segment(pointer data, size_type size) noexcept
+      : data_(data), size_(size) {}
+
+  //! \brief Non-const to const segment conversion.
+  template <typename U_ = T_, std::enable_if_t<!std::is_const_v<U_>, int> = 0>
+  constexpr operator segment<U_ const>() const noexcept {
+    return {data_, size_};
+  }
+
+  constexpr pointer data() const noexcept { return data_; }
+
+  constexpr size_type size() const noexcept { return size_; }
+
+  constexpr size_type size_bytes() const noexcept {
+    return size_ * sizeof(T_);
+  }
+
+  constexpr bool empty() const noexcept { return size_ == 0; }
+
+  constexpr reference operator[](size_type i) const noexcept {
+    return data_[i];
+  }
+
+  constexpr iterator begin() const noexcept { return data_; }
+
+  constexpr iterator end() const noexcept { return data_ + size_; }
+
+ private:
+  pointer data_;
+  size_type size_;
+};
+
 namespace internal {
 
 //! \brief Wrap \p index from the expected input range of
@@ -85,6 +135,9 @@ class cyclic_deque_impl {
   using maybe_const_iterator =
       typename range_traits<Container_>::maybe_const_iterator;
 
+  using segment_pair = std::array<segment<value_type>, 2>;
+  using const_segment_pair = std::array<segment<value_type const>, 2>;
+
   constexpr cyclic_deque_impl() noexcept
       : buf(), deq_start(), deq_finish(), deq_size() {}
 
@@ -245,6 +298,19 @@ class cyclic_deque_impl {
     --deq_size;
   }
 
+  //! \brief Remove the first \p n elements.
+  constexpr void pop_front(size_type n) noexcept {
+    assert(n <= size());
+    deq_start = inner_to_outer(n);
+    deq_size -= n;
+  }
+
+  //! \brief Remove the last \p n elements.
+  constexpr void pop_back(size_type n) noexcept {
+    assert(n <= size());
+    resize(size() - n);
+  }
+
   template <typename Range_>
   constexpr void append_range(Range_&& rg) {
     // Use std::ranges::end(), etc., with C++20 or higher.
@@ -329,6 +395,31 @@ class cyclic_deque_impl {
     deq_size = static_cast<size_type>(s + d);
   }
 
+  //! \brief Return the occupied range [deq_start...deq_finish) as two
+  //! contiguous segments. The first segment starts at deq_start and the second
+  //! segment, which may be empty, starts at buf.begin().
+  constexpr segment_pair used_segments() noexcept {
+    auto first = static_cast<size_type>(deq_start - buf.begin());
+    auto size1 = std::min(deq_size, capacity() - first);
+    return {{{buf.data() + first, size1}, {buf.data(), deq_size - size1}}};
+  }
+
+  //! \copydoc used_segments()
+  constexpr const_segment_pair used_segments() const noexcept {
+    auto first = static_cast<size_type>(deq_start - buf.begin());
+    auto size1 = std::min(deq_size, capacity() - first);
+    return {{{buf.data() + first, size1}, {buf.data(), deq_size - size1}}};
+  }
+
+  //! \brief Return the unoccupied range [deq_finish...deq_start) as two
+  //! contiguous segments. The first segment starts at deq_finish and the
+  //! second segment, which may be empty, starts at buf.begin().
+  constexpr segment_pair free_segments() noexcept {
+    auto first = static_cast<size_type>(deq_finish - buf.begin());
+    auto size1 = std::min(available(), capacity() - first);
+    return {{{buf.data() + first, size1}, {buf.data(), available() - size1}}};
+  }
+
   container buf;
   iterator deq_start;
   //! \brief One past-the-last element for the cycle. The value for deq_finish
@@ -532,6 +623,9 @@ class cyclic_deque {
   using reverse_iterator = std::reverse_iterator<iterator>;
   using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
+  using segment_pair = typename cyclic_impl::segment_pair;
+  using const_segment_pair = typename cyclic_impl::const_segment_pair;
+
   constexpr cyclic_deque() noexcept(noexcept(allocator_type())) = default;
 
   constexpr explicit cyclic_deque(allocator_type const& a) noexcept
@@ -620,6 +714,14 @@ class cyclic_deque {
   //! \details Undefined behavior if the cyclic_deque is empty.
   constexpr void pop_front() noexcept { impl_.pop_front(); }
 
+  //! \brief Remove the first \p n elements.
+  //! \details Undefined behavior if \p n exceeds size().
+  constexpr void pop_front(size_type n) noexcept { impl_.pop_front(n); }
+
+  //! \brief Remove the last \p n elements.
+  //! \details Undefined behavior if \p n exceeds size().
+  constexpr void pop_back(size_type n) noexcept { impl_.pop_back(n); }
+
   //! \brief Append a copy of the elements of range \p rg to the contents of the
   //! cyclic_deque. Undefined behavior if available() is not sufficient to
   //! accomodate the range.
@@ -665,6 +767,26 @@ class cyclic_deque {
   //! \brief Return true if the cyclic_deque is full.
   constexpr bool full() const noexcept { return impl_.full(); }
 
+  //! \brief Return the elements of the cyclic_deque as two contiguous
+  //! segments, in order. The second segment is empty when the elements don't
+  //! wrap around the end of the buffer.
+  constexpr segment_pair used_segments() noexcept {
+    return impl_.used_segments();
+  }
+
+  //! \copydoc used_segments()
+  constexpr const_segment_pair used_segments() const noexcept {
+    return impl_.used_segments();
+  }
+
+  //! \brief Return the unoccupied capacity of the cyclic_deque as two
+  //! contiguous segments, in the order in which push_back() would fill them.
+  //! \details Elements written to the free segments can be made part of the
+  //! cyclic_deque by calling resize(size() + n).
+  constexpr segment_pair free_segments() noexcept {
+    return impl_.free_segments();
+  }
+
   constexpr iterator begin() noexcept {
     return iterator(&impl_, difference_type(0));
   }
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <algorithm>
+#include <streambuf>
+#include <string>
+
+#include "cyclic_deque.hpp"
+
+namespace ouroboros {
+
+//! \brief A stream buffer that reads from the front and writes to the back of a
+//! cyclic_deque, without any buffering of its own.
+//! \details The get area is the first contiguous segment of the elements of the
+//! cyclic_deque and the put area is the first contiguous segment of its
+//! unoccupied capacity. Characters are consumed from, and written to, the
+//! cyclic_deque once the stream buffer synchronizes, i.e., when an area is
+//! exhausted, on pubsync() (or std::ostream::flush()), or on destruction. The
+//! cyclic_deque should not be modified directly while the stream buffer holds
+//! unsynchronized characters. Writing to a full cyclic_deque fails and reading
+//! from an empty one results in the end of the file.
+template <
+    typename CharT_,
+    typename Traits_ = std::char_traits<CharT_>,
+    typename Allocator_ = std::allocator<CharT_>>
+class basic_cyclic_streambuf : public std::basic_streambuf<CharT_, Traits_> {
+  using base = std::basic_streambuf<CharT_, Traits_>;
+
+ public:
+  using char_type = typename base::char_type;
+  using traits_type = typename base::traits_type;
+  using int_type = typename base::int_type;
+  using pos_type = typename base::pos_type;
+  using off_type = typename base::off_type;
+  using deque_type = cyclic_deque<CharT_, Allocator_>;
+
+  explicit basic_cyclic_streambuf(deque_type& deque) : deque_(&deque) {
+    update_areas();
+  }
+
+  basic_cyclic_streambuf(basic_cyclic_streambuf const&) = delete;
+
+  basic_cyclic_streambuf& operator=(basic_cyclic_streambuf const&) = delete;
+
+  ~basic_cyclic_streambuf() override { commit(); }
+
+  //! \brief Return the cyclic_deque of the stream buffer. Call pubsync() first
+  //! to make it reflect all the reads and writes.
+  deque_type& deque() const noexcept { return *deque_; }
+
+ protected:
+  int_type overflow(int_type c) override {
+    sync_areas();
+    if (traits_type::eq_int_type(c, traits_type::eof())) {
+      return traits_type::not_eof(c);
+    }
+    if (this->pptr() == this->epptr()) {
+      return traits_type::eof();
+    }
+    *this->pptr() = traits_type::to_char_type(c);
+    this->pbump(1);
+    return c;
+  }
+
+  int_type underflow() override {
+    sync_areas();
+    if (this->gptr() == this->egptr()) {
+      return traits_type::eof();
+    }
+    return traits_type::to_int_type(*this->gptr());
+  }
+
+  std::streamsize xsputn(char_type const* s, std::streamsize n) override {
+    commit();
+    auto count = std::min(static_cast<std::size_t>(n), deque_->available());
+    deque_->append_range(segment<char_type const>(s, count));
+    update_areas();
+    return static_cast<std::streamsize>(count);
+  }
+
+  std::streamsize xsgetn(char_type* s, std::streamsize n) override {
+    commit();
+    auto count = std::min(static_cast<std::size_t>(n), deque_->size());
+    auto remaining = count;
+    for (auto const& seg : deque_->used_segments()) {
+      auto c = std::min(remaining, seg.size());
+      s = traits_type::copy(s, seg.data(), c) + c;
+      remaining -= c;
+    }
+    deque_->pop_front(count);
+    update_areas();
+    return static_cast<std::streamsize>(count);
+  }
+
+  std::streamsize showmanyc() override {
+    auto size = deque_->size() + static_cast<std::size_t>(written()) -
+                static_cast<std::size_t>(consumed());
+    return size > 0 ? static_cast<std::streamsize>(size) : -1;
+  }
+
+  int sync() override {
+    sync_areas();
+    return 0;
+  }
+
+ private:
+  std::ptrdiff_t consumed() const noexcept {
+    return this->gptr() - this->eback();
+  }
+
+  std::ptrdiff_t written() const noexcept {
+    return this->pptr() - this->pbase();
+  }
+
+  //! \brief Apply the reads and writes of the get and put areas to the deque.
+  void commit() noexcept {
+    deque_->resize(deque_->size() + static_cast<std::size_t>(written()));
+    deque_->pop_front(static_cast<std::size_t>(consumed()));
+    this->setg(this->eback(), this->eback(), this->eback());
+    this->setp(this->pbase(), this->pbase());
+  }
+
+  void update_areas() noexcept {
+    auto g = deque_->used_segments()[0];
+    this->setg(g.data(), g.data(), g.data() + g.size());
+    auto p = deque_->free_segments()[0];
+    this->setp(p.data(), p.data() + p.size());
+  }
+
+  void sync_areas() noexcept {
+    commit();
+    update_areas();
+  }
+
+  deque_type* deque_;
+};
+
+using cyclic_streambuf = basic_cyclic_streambuf<char>;
+
+using wcyclic_streambuf = basic_cyclic_streambuf<wchar_t>;
+
+}  // namespace ouroboros
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "concurrency.hpp"
+
+namespace ouroboros {
+
+//! \brief A sequence number padded to a cache line of its own.
+class alignas(internal::cache_line_size) sequence {
+ public:
+  using value_type = std::int64_t;
+
+  //! \brief The value of a sequence before anything was published or
+  //! processed.
+  static constexpr value_type initial_value = -1;
+
+  constexpr sequence() noexcept : value_(initial_value) {}
+
+  sequence(sequence const&) = delete;
+
+  sequence& operator=(sequence const&) = delete;
+
+  value_type load() const noexcept {
+    return value_.load(std::memory_order_acquire);
+  }
+
+  void store(value_type v) noexcept {
+    value_.store(v, std::memory_order_release);
+  }
+
+ private:
+  std::atomic<value_type> value_;
+};
+
+//! \brief A single-producer ring of pre-allocated slots that is processed in
+//! place by multiple consumer stages, in the style of the LMAX Disruptor.
+//! \details The producer claims slots from the sequencer, writes events into
+//! them and publishes them by advancing the cursor. Each stage has its own
+//! sequence and may declare dependencies on other stages: a stage never
+//! processes a slot that hasn't been processed by all of its dependencies.
+//! The producer is gated by the slowest stage, such that it never overwrites a
+//! slot that is still unprocessed. Events are never copied between stages.
+//!
+//! All stages must be added before the producer and stages start running. The
+//! capacity is rounded up to a power of two.
+template <typename T_, typename Allocator_ = std::allocator<T_>>
+class disruptor {
+  static_assert(
+      std::is_same_v<std::remove_cv_t<T_>, T_>,
+      "ouroboros::disruptor must have a non-const, non-volatile value_type");
+
+  using container = std::vector<T_, Allocator_>;
+
+ public:
+  using allocator_type = typename container::allocator_type;
+  using size_type = std::size_t;
+  using value_type = T_;
+  using reference = T_&;
+  using sequence_type = sequence::value_type;
+
+  //! \brief A consumer of the events of a disruptor.
+  class stage {
+   public:
+    stage(stage const&) = delete;
+
+    stage& operator=(stage const&) = delete;
+
+    //! \brief Return the highest sequence that this stage may process: the
+    //! minimum of the producer cursor and the sequences of its dependencies.
+    sequence_type available() const noexcept {
+      sequence_type a = owner_->cursor_.load();
+      for (sequence const* d : dependencies_) {
+        a = std::min(a, d->load());
+      }
+      return a;
+    }
+
+    //! \brief Call \p f(event, sequence) for each event that is available to
+    //! this stage and mark them as processed. Returns the number of events that
+    //! were processed. Non-blocking.
+    template <typename F_>
+    size_type process(F_&& f) {
+      sequence_type next = sequence_.load() + 1;
+      sequence_type last = available();
+      for (sequence_type s = next; s <= last; ++s) {
+        f((*owner_)[s], s);
+      }
+      if (last >= next) {
+        sequence_.store(last);
+        return static_cast<size_type>(last - next + 1);
+      }
+      return 0;
+    }
+
+    //! \brief Mark all events up to and including \p s as processed.
+    void commit(sequence_type s) noexcept { sequence_.store(s); }
+
+    //! \brief Return the sequence of the last processed event.
+    sequence_type processed() const noexcept { return sequence_.load(); }
+
+   private:
+    friend class disruptor;
+
+    stage(disruptor* owner, std::vector<sequence const*> dependencies)
+        : owner_(owner), dependencies_(std::move(dependencies)) {}
+
+    sequence sequence_;
+    disruptor* owner_;
+    std::vector<sequence const*> dependencies_;
+  };
+
+  //! \brief Create a disruptor with at least \p c slots.
+  explicit disruptor(size_type c, allocator_type const& a = allocator_type())
+      : buf_(internal::ceil_power_of_two(c), a),
+        mask_(buf_.size() - 1),
+        next_(0),
+        cached_gate_(sequence::initial_value) {}
+
+  disruptor(disruptor const&) = delete;
+
+  disruptor& operator=(disruptor const&) = delete;
+
+  //! \brief Add a stage that processes events after all stages in
+  //! \p dependencies have processed them, or directly after they are
+  //! published when \p dependencies is empty. The returned reference remains
+  //! valid for the lifetime of the disruptor.
+  stage& add_stage(std::initializer_list<stage const*> dependencies = {}) {
+    std::vector<sequence const*> d;
+    for (stage const* s : dependencies) {
+      assert(s->owner_ == this);
+      d.push_back(&s->sequence_);
+    }
+    stages_.emplace_back(new stage(this, std::move(d)));
+    return *stages_.back();
+  }
+
+  //! \brief Claim the next \p n slots and return the sequence of the last one.
+  //! Waits until the slowest stage has processed the events that occupied the
+  //! slots. Producer only.
+  //! \details Undefined behavior if \p n exceeds capacity().
+  sequence_type claim(size_type n = 1) {
+    sequence_type last = next_ + static_cast<sequence_type>(n) - 1;
+    while (!has_capacity(last)) {
+      std::this_thread::yield();
+    }
+    next_ = last + 1;
+    return last;
+  }
+
+  //! \brief Claim the next \p n slots if they are free. Returns the sequence of
+  //! the last one, or sequence::initial_value otherwise. Producer only.
+  sequence_type try_claim(size_type n = 1) {
+    sequence_type last = next_ + static_cast<sequence_type>(n) - 1;
+    if (!has_capacity(last)) {
+      return sequence::initial_value;
+    }
+    next_ = last + 1;
+    return last;
+  }
+
+  //! \brief Make all claimed events up to and including \p s available to the
+  //! stages. Producer only.
+  void publish(sequence_type s) noexcept { cursor_.store(s); }
+
+  //! \brief Return a reference to the slot of sequence \p s.
+  reference operator[](sequence_type s) noexcept {
+    return buf_[static_cast<size_type>(s) & mask_];
+  }
+
+  //! \brief Return the sequence of the last published event.
+  sequence_type cursor() const noexcept { return cursor_.load(); }
+
+  //! \brief Return the number of slots.
+  size_type capacity() const noexcept { return buf_.size(); }
+
+ private:
+  //! \brief Return true when the slot of sequence \p last is no longer in use
+  //! by any stage.
+  bool has_capacity(sequence_type last) noexcept {
+    sequence_type wrap = last - static_cast<sequence_type>(capacity());
+    if (wrap > cached_gate_) {
+      cached_gate_ = gate();
+    }
+    return wrap <= cached_gate_;
+  }
+
+  //! \brief Return the sequence of the slowest stage.
+  sequence_type gate() const noexcept {
+    sequence_type g = cursor_.load();
+    for (auto const& s : stages_) {
+      g = std::min(g, s->sequence_.load());
+    }
+    return g;
+  }
+
+  // Shared and read-only once running.
+  alignas(internal::cache_line_size) container buf_;
+  size_type mask_;
+  std::vector<std::unique_ptr<stage>> stages_;
+  // Written by the producer.
+  alignas(internal::cache_line_size) sequence_type next_;
+  sequence_type cached_gate_;
+  sequence cursor_;
+};
+
+}  // namespace ouroboros
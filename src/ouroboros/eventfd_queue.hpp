@@ -0,0 +1,133 @@
+#pragma once
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <limits>
+#include <system_error>
+#include <utility>
+
+namespace ouroboros {
+
+//! \brief Wraps one of the concurrent queues, spsc_cyclic_queue,
+//! mpsc_cyclic_queue or mpmc_cyclic_queue, and signals an eventfd when the
+//! queue goes from empty to non-empty (Linux).
+//! \details The file descriptor can be registered with epoll, select or poll
+//! such that an event loop is woken up when other threads push elements. The
+//! consumer is expected to run in the event loop and to drain the queue in
+//! batches with drain().
+//!
+//! Notifications are coalesced: the consumer arms the queue when it finds it
+//! empty and the first push after that signals the eventfd and disarms it.
+//! Pushes into a non-empty queue don't make a system call. At most one thread
+//! may call drain() at a time.
+template <typename Queue_>
+class eventfd_queue {
+ public:
+  using queue_type = Queue_;
+  using size_type = typename Queue_::size_type;
+  using value_type = typename Queue_::value_type;
+
+  //! \brief Create the wrapped queue from \p args and a non-blocking eventfd.
+  //! Throws std::system_error when the eventfd cannot be created.
+  template <typename... Args_>
+  explicit eventfd_queue(Args_&&... args)
+      : queue_(std::forward<Args_>(args)...),
+        fd_(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+        armed_(true) {
+    if (fd_ < 0) {
+      throw std::system_error(
+          errno, std::generic_category(), "ouroboros::eventfd_queue: eventfd");
+    }
+  }
+
+  eventfd_queue(eventfd_queue const&) = delete;
+
+  eventfd_queue& operator=(eventfd_queue const&) = delete;
+
+  ~eventfd_queue() { ::close(fd_); }
+
+  //! \brief Return the eventfd. It becomes readable when elements are
+  //! available. Don't read from it or close it.
+  int fd() const noexcept { return fd_; }
+
+  //! \brief Add an element to the end of the queue. Returns false if the queue
+  //! is full.
+  template <typename U_>
+  bool try_push(U_&& value) {
+    if (!queue_.try_push(std::forward<U_>(value))) {
+      return false;
+    }
+    // Pairs with the fence in drain(). Either the consumer sees the element
+    // after arming, or we see that it is armed.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (armed_.load(std::memory_order_relaxed) &&
+        armed_.exchange(false, std::memory_order_relaxed)) {
+      signal();
+    }
+    return true;
+  }
+
+  //! \brief Pop up to \p max elements and call \p f(value) for each of them.
+  //! Returns the number of elements popped. Consumer only.
+  //! \details When the queue is empty afterwards it is armed, such that the
+  //! next push signals the eventfd. When \p max elements were popped the
+  //! eventfd is left readable, such that a level-triggered event loop returns
+  //! to the queue on its next iteration.
+  template <typename F_>
+  size_type drain(
+      F_&& f, size_type max = std::numeric_limits<size_type>::max()) {
+    clear();
+    size_type n = 0;
+    value_type value;
+    while (n < max && queue_.try_pop(value)) {
+      f(std::move(value));
+      ++n;
+    }
+
+    if (n == max) {
+      signal();
+      return n;
+    }
+
+    armed_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // An element that was pushed before the queue was armed wouldn't signal.
+    if (!queue_.empty() && armed_.exchange(false, std::memory_order_relaxed)) {
+      signal();
+    }
+    return n;
+  }
+
+  //! \brief Return the maximum number of elements the queue can hold.
+  size_type capacity() const noexcept { return queue_.capacity(); }
+
+  //! \brief Return the approximate number of elements in the queue.
+  size_type size() const noexcept { return queue_.size(); }
+
+  //! \brief Return true if the queue is approximately empty.
+  bool empty() const noexcept { return queue_.empty(); }
+
+ private:
+  void signal() noexcept {
+    std::uint64_t one = 1;
+    // Can only fail with EAGAIN when the counter would overflow, in which
+    // case the eventfd is readable anyway.
+    [[maybe_unused]] auto r = ::write(fd_, &one, sizeof(one));
+  }
+
+  void clear() noexcept {
+    std::uint64_t count;
+    // Fails with EAGAIN when the eventfd wasn't signalled.
+    [[maybe_unused]] auto r = ::read(fd_, &count, sizeof(count));
+  }
+
+  Queue_ queue_;
+  int fd_;
+  std::atomic<bool> armed_;
+};
+
+}  // namespace ouroboros
@@ -0,0 +1,320 @@
+#pragma once
+
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+
+#include "cyclic_deque.hpp"
+#include "serialization.hpp"
+
+namespace ouroboros {
+
+namespace io {
+
+//! \brief The reason an io operation stopped transferring data.
+enum class io_status {
+  //! \brief The transfer succeeded, possibly partially.
+  ok,
+  //! \brief The (non-blocking) file descriptor was not ready. Nothing was
+  //! transferred.
+  would_block,
+  //! \brief The end of the file was reached. Nothing was transferred.
+  end_of_file,
+  //! \brief The end of the file was reached within an element. The bytes of
+  //! that element that were read earlier are discarded. Nothing was
+  //! transferred.
+  truncated
+};
+
+//! \brief The result of fill_from_fd() and drain_to_fd().
+struct io_result {
+  //! \brief The number of elements transferred.
+  std::size_t count;
+  io_status status;
+};
+
+//! \brief The progress of fill_from_fd() or drain_to_fd() within an element
+//! that was only partially transferred, for a value_type larger than one byte.
+//! \details Pass the same partial_element to each call for the same ring and
+//! file descriptor. While bytes is non-zero, fill_from_fd() keeps the bytes
+//! read so far in the unoccupied capacity right after the back of the ring,
+//! and drain_to_fd() keeps the partially written element at the front of the
+//! ring. Undefined behavior if the back of the ring (fill_from_fd()) or the
+//! front of the ring (drain_to_fd()) is modified in the meantime.
+struct partial_element {
+  //! \brief The number of bytes of the element that were transferred.
+  std::size_t bytes = 0;
+};
+
+}  // namespace io
+
+namespace internal {
+
+//! \brief Describe the bytes of \p segments, skipping the first \p offset
+//! bytes, with at most two iovecs. Returns the number of iovecs.
+template <typename Segments_>
+int to_iovecs(
+    Segments_ const& segments, std::size_t offset, iovec* iov) noexcept {
+  int iovcnt = 0;
+  for (auto const& s : segments) {
+    auto bytes = s.size_bytes();
+    if (offset >= bytes) {
+      offset -= bytes;
+      continue;
+    }
+    iov[iovcnt].iov_base = const_cast<char*>(
+        reinterpret_cast<char const*>(s.data()) + offset);
+    iov[iovcnt].iov_len = bytes - offset;
+    offset = 0;
+    ++iovcnt;
+  }
+  return iovcnt;
+}
+
+[[noreturn]] inline void throw_system_error(char const* what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+inline bool is_would_block(int e) noexcept {
+  return e == EAGAIN || e == EWOULDBLOCK;
+}
+
+//! \brief Transfer exactly \p n bytes, waiting for the file descriptor to
+//! become ready when needed. Used by fd_writer and fd_reader, which must
+//! transfer all bytes. Returns the amount of bytes transferred, which is only
+//! smaller than \p n at the end of the file.
+template <bool Read_>
+std::size_t transfer_all(int fd, char* p, std::size_t n, char const* what) {
+  std::size_t done = 0;
+  while (done < n) {
+    ssize_t r;
+    if constexpr (Read_) {
+      r = ::read(fd, p + done, n - done);
+    } else {
+      r = ::write(fd, p + done, n - done);
+    }
+
+    if (r > 0) {
+      done += static_cast<std::size_t>(r);
+    } else if (r == 0) {
+      break;
+    } else if (errno == EINTR) {
+      continue;
+    } else if (is_would_block(errno)) {
+      pollfd pfd{fd, static_cast<short>(Read_ ? POLLIN : POLLOUT), 0};
+      if (::poll(&pfd, 1, -1) < 0 && errno != EINTR) {
+        throw_system_error("ouroboros::io: poll");
+      }
+    } else {
+      throw_system_error(what);
+    }
+  }
+  return done;
+}
+
+template <typename T_>
+constexpr void static_assert_io_value_type() {
+  static_assert(
+      std::is_trivially_copyable_v<T_>,
+      "ouroboros::io requires a trivially copyable value_type");
+}
+
+template <typename T_>
+constexpr void static_assert_io_byte_type() {
+  static_assert(
+      sizeof(T_) == 1,
+      "ouroboros::io requires an io::partial_element for a value_type larger "
+      "than one byte");
+}
+
+}  // namespace internal
+
+namespace io {
+
+//! \brief Read from file descriptor \p fd into the unoccupied capacity of
+//! \p ring using a single readv() call, and append the elements that were read
+//! to the back of \p ring.
+//! \details When the value_type of \p ring is larger than one byte, readv()
+//! may return a partially read element. Its bytes are kept in \p partial and
+//! the element is appended by a later call, such that the call never waits for
+//! a non-blocking \p fd. Throws an std::system_error on any error other than
+//! EINTR, EAGAIN or EWOULDBLOCK.
+template <typename T_, typename Allocator_>
+io_result fill_from_fd(
+    cyclic_deque<T_, Allocator_>& ring, int fd, partial_element& partial) {
+  internal::static_assert_io_value_type<T_>();
+  assert(partial.bytes < sizeof(T_));
+
+  iovec iov[2];
+  int iovcnt = internal::to_iovecs(ring.free_segments(), partial.bytes, iov);
+  if (iovcnt == 0) {
+    return {0, io_status::ok};
+  }
+
+  ssize_t r;
+  do {
+    r = ::readv(fd, iov, iovcnt);
+  } while (r < 0 && errno == EINTR);
+
+  if (r < 0) {
+    if (internal::is_would_block(errno)) {
+      return {0, io_status::would_block};
+    }
+    internal::throw_system_error("ouroboros::io::fill_from_fd: readv");
+  } else if (r == 0) {
+    if (partial.bytes != 0) {
+      partial.bytes = 0;
+      return {0, io_status::truncated};
+    }
+    return {0, io_status::end_of_file};
+  }
+
+  auto bytes = partial.bytes + static_cast<std::size_t>(r);
+  partial.bytes = bytes % sizeof(T_);
+  auto count = bytes / sizeof(T_);
+  ring.resize(ring.size() + count);
+  return {count, io_status::ok};
+}
+
+//! \brief Read from file descriptor \p fd into the unoccupied capacity of
+//! \p ring, for a value_type of one byte.
+//! \see fill_from_fd(cyclic_deque<T_, Allocator_>&, int, partial_element&)
+template <typename T_, typename Allocator_>
+io_result fill_from_fd(cyclic_deque<T_, Allocator_>& ring, int fd) {
+  internal::static_assert_io_byte_type<T_>();
+  partial_element partial;
+  return fill_from_fd(ring, fd, partial);
+}
+
+//! \brief Write the elements of \p ring to file descriptor \p fd using a single
+//! writev() call, and remove the elements that were written from the front of
+//! \p ring.
+//! \details When the value_type of \p ring is larger than one byte, writev()
+//! may return a partially written element. That element stays at the front of
+//! \p ring, and a later call continues after the \p partial.bytes that were
+//! written, such that no byte is written twice and the call never waits for a
+//! non-blocking \p fd. Throws an std::system_error on any error other than
+//! EINTR, EAGAIN or EWOULDBLOCK.
+template <typename T_, typename Allocator_>
+io_result drain_to_fd(
+    cyclic_deque<T_, Allocator_>& ring, int fd, partial_element& partial) {
+  internal::static_assert_io_value_type<T_>();
+  assert(partial.bytes < sizeof(T_));
+
+  iovec iov[2];
+  int iovcnt = internal::to_iovecs(ring.used_segments(), partial.bytes, iov);
+  if (iovcnt == 0) {
+    return {0, io_status::ok};
+  }
+
+  ssize_t r;
+  do {
+    r = ::writev(fd, iov, iovcnt);
+  } while (r < 0 && errno == EINTR);
+
+  if (r < 0) {
+    if (internal::is_would_block(errno)) {
+      return {0, io_status::would_block};
+    }
+    internal::throw_system_error("ouroboros::io::drain_to_fd: writev");
+  }
+
+  auto bytes = partial.bytes + static_cast<std::size_t>(r);
+  partial.bytes = bytes % sizeof(T_);
+  auto count = bytes / sizeof(T_);
+  ring.pop_front(count);
+  return {count, io_status::ok};
+}
+
+//! \brief Write the elements of \p ring to file descriptor \p fd, for a
+//! value_type of one byte.
+//! \see drain_to_fd(cyclic_deque<T_, Allocator_>&, int, partial_element&)
+template <typename T_, typename Allocator_>
+io_result drain_to_fd(cyclic_deque<T_, Allocator_>& ring, int fd) {
+  internal::static_assert_io_byte_type<T_>();
+  partial_element partial;
+  return drain_to_fd(ring, fd, partial);
+}
+
+//! \brief A writer for serialize() that writes all bytes to a file
+//! descriptor. Throws an std::system_error on failure.
+class fd_writer {
+ public:
+  explicit fd_writer(int fd) noexcept : fd_(fd) {}
+
+  void operator()(void const* data, std::size_t bytes) const {
+    auto* p = const_cast<char*>(static_cast<char const*>(data));
+    if (internal::transfer_all<false>(
+            fd_, p, bytes, "ouroboros::io::fd_writer: write") != bytes) {
+      throw std::runtime_error("ouroboros::io::fd_writer: short write");
+    }
+  }
+
+ private:
+  int fd_;
+};
+
+//! \brief A reader for deserialize() that reads all bytes from a file
+//! descriptor. Throws an std::system_error on failure and an
+//! std::runtime_error when the end of the file is reached early.
+class fd_reader {
+ public:
+  explicit fd_reader(int fd) noexcept : fd_(fd) {}
+
+  void operator()(void* data, std::size_t bytes) const {
+    if (internal::transfer_all<true>(
+            fd_,
+            static_cast<char*>(data),
+            bytes,
+            "ouroboros::io::fd_reader: read") != bytes) {
+      throw std::runtime_error("ouroboros::io::fd_reader: unexpected EOF");
+    }
+  }
+
+ private:
+  int fd_;
+};
+
+//! \brief Create a cyclic_deque from a snapshot stored in the file referred to
+//! by \p fd by memory-mapping the file. The contents are copied into the new
+//! cyclic_deque using a single copy. The file offset of \p fd is ignored.
+template <typename T_, typename Allocator_ = std::allocator<T_>>
+cyclic_deque<T_, Allocator_> deserialize_mapped(
+    int fd, Allocator_ const& a = Allocator_()) {
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    internal::throw_system_error("ouroboros::io::deserialize_mapped: fstat");
+  }
+  auto bytes = static_cast<std::size_t>(st.st_size);
+  if (bytes == 0) {
+    throw std::runtime_error(
+        "ouroboros::io::deserialize_mapped: the snapshot is truncated");
+  }
+
+  void* data = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == MAP_FAILED) {
+    internal::throw_system_error("ouroboros::io::deserialize_mapped: mmap");
+  }
+  // Unmap the file, also when deserialize() throws.
+  struct mapping {
+    ~mapping() { ::munmap(data, bytes); }
+
+    void* data;
+    std::size_t bytes;
+  } m{data, bytes};
+  ::madvise(data, bytes, MADV_SEQUENTIAL);
+  return deserialize<T_, Allocator_>(data, bytes, a);
+}
+
+}  // namespace io
+
+}  // namespace ouroboros
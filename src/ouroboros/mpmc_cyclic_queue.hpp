@@ -0,0 +1,176 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "concurrency.hpp"
+#include "contention_stats.hpp"
+
+namespace ouroboros {
+
+//! \brief A lock-free, bounded, multi-producer multi-consumer FIFO queue.
+//! \details Based on the queue by Dmitry Vyukov. Each slot carries an atomic
+//! sequence number that tells producers and consumers whether the slot is
+//! ready to be written or read for a given lap around the buffer. Producers
+//! and consumers claim positions with a compare-and-swap on the tail and the
+//! head respectively. Positions increase monotonically, so a slot is never
+//! mistaken for one from a previous lap (no ABA).
+//!
+//! The capacity is rounded up to a power of two such that a position maps to a
+//! slot using a mask instead of a division.
+//!
+//! Nothing may throw between claiming a slot and publishing or releasing it,
+//! or the slot would block the queue for good. The value_type must therefore
+//! be nothrow move assignable, and a value that can't be assigned without
+//! throwing is converted to a value_type before a slot is claimed.
+//!
+//! The Stats_ policy records failed compare-and-swaps and full and empty
+//! queues. See contention_stats.
+template <
+    typename T_,
+    typename Allocator_ = std::allocator<T_>,
+    typename Stats_ = no_stats>
+class mpmc_cyclic_queue {
+  static_assert(
+      std::is_same_v<std::remove_cv_t<T_>, T_>,
+      "ouroboros::mpmc_cyclic_queue must have a non-const, non-volatile "
+      "value_type");
+  static_assert(
+      std::is_nothrow_move_assignable_v<T_>,
+      "ouroboros::mpmc_cyclic_queue requires a nothrow move assignable "
+      "value_type");
+
+  struct cell {
+    std::atomic<std::size_t> sequence;
+    T_ value;
+  };
+
+  using cell_allocator =
+      typename std::allocator_traits<Allocator_>::template rebind_alloc<cell>;
+  using container = std::vector<cell, cell_allocator>;
+
+ public:
+  using allocator_type = Allocator_;
+  using stats_type = Stats_;
+  using size_type = std::size_t;
+  using value_type = T_;
+  using reference = T_&;
+  using const_reference = T_ const&;
+
+  //! \brief Create a queue that can hold at least \p c elements.
+  explicit mpmc_cyclic_queue(
+      size_type c, allocator_type const& a = allocator_type())
+      : cells_(internal::ceil_power_of_two(c), cell_allocator(a)),
+        mask_(cells_.size() - 1),
+        tail_(0),
+        head_(0) {
+    for (size_type i = 0; i < cells_.size(); ++i) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  mpmc_cyclic_queue(mpmc_cyclic_queue const&) = delete;
+
+  mpmc_cyclic_queue& operator=(mpmc_cyclic_queue const&) = delete;
+
+  //! \brief Add an element to the end of the queue. Returns false if the queue
+  //! is full.
+  template <typename U_>
+  bool try_push(U_&& value) {
+    if constexpr (!std::is_nothrow_assignable_v<T_&, U_&&>) {
+      return try_push(value_type(std::forward<U_>(value)));
+    }
+    size_type pos = tail_.load(std::memory_order_relaxed);
+    cell* c;
+    for (;;) {
+      c = &cells_[pos & mask_];
+      size_type seq = c->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+      if (diff == 0) {
+        // The slot is free for this lap. Claim it.
+        if (tail_.compare_exchange_weak(
+                pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+        stats_.cas_retry();
+      } else if (diff < 0) {
+        // The slot still holds an element of the previous lap.
+        stats_.full();
+        return false;
+      } else {
+        // Another producer claimed the position.
+        stats_.cas_retry();
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+    c->value = std::forward<U_>(value);
+    c->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  //! \brief Remove the first element of the queue and move it into \p value.
+  //! Returns false if the queue is empty.
+  bool try_pop(value_type& value) {
+    size_type pos = head_.load(std::memory_order_relaxed);
+    cell* c;
+    for (;;) {
+      c = &cells_[pos & mask_];
+      size_type seq = c->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+      if (diff == 0) {
+        // The slot was published for this lap. Claim it.
+        if (head_.compare_exchange_weak(
+                pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+        stats_.cas_retry();
+      } else if (diff < 0) {
+        // The slot hasn't been published yet.
+        stats_.empty();
+        return false;
+      } else {
+        // Another consumer claimed the position.
+        stats_.cas_retry();
+        pos = head_.load(std::memory_order_relaxed);
+      }
+    }
+    value = std::move(c->value);
+    // Release the slot for the next lap.
+    c->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+  //! \brief Return the maximum number of elements the queue can hold.
+  size_type capacity() const noexcept { return cells_.size(); }
+
+  //! \brief Return the approximate number of elements in the queue.
+  size_type size() const noexcept {
+    size_type head = head_.load(std::memory_order_acquire);
+    size_type tail = tail_.load(std::memory_order_acquire);
+    return tail > head ? tail - head : 0;
+  }
+
+  //! \brief Return true if the queue is approximately empty.
+  bool empty() const noexcept { return size() == 0; }
+
+  //! \brief Return the statistics policy.
+  stats_type& stats() noexcept { return stats_; }
+
+  //! \brief Return the statistics policy.
+  stats_type const& stats() const noexcept { return stats_; }
+
+ private:
+  // Shared and read-only after construction.
+  alignas(internal::cache_line_size) container cells_;
+  size_type mask_;
+  Stats_ stats_;
+  // Claimed by producers.
+  alignas(internal::cache_line_size) std::atomic<size_type> tail_;
+  // Claimed by consumers.
+  alignas(internal::cache_line_size) std::atomic<size_type> head_;
+};
+
+}  // namespace ouroboros
@@ -0,0 +1,277 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "concurrency.hpp"
+#include "contention_stats.hpp"
+#include "cyclic_deque.hpp"
+
+namespace ouroboros {
+
+//! \brief A lock-free, bounded, multi-producer single-consumer FIFO queue in
+//! which producers claim contiguous ranges of slots.
+//! \details A producer claims a range of slots by advancing the tail, writes
+//! the elements directly into the slots and publishes them. Each slot has a
+//! ready flag that holds the position of the element it was last published
+//! for, such that flags never have to be reset. The consumer reads the longest
+//! published run of elements from the head as at most two contiguous segments.
+//!
+//! Elements and ready flags are stored in separate arrays, such that the
+//! elements of a claim are contiguous in memory. The capacity is rounded up to
+//! a power of two.
+//!
+//! A claimed slot blocks the consumer until it is published. The value_type
+//! must therefore be nothrow move assignable, such that try_push() can convert
+//! its value to a value_type before claiming a slot and nothing throws between
+//! the claim and its publication.
+//!
+//! The Stats_ policy records failed compare-and-swaps, full and empty queues
+//! and the time producers wait in claim(). See contention_stats.
+template <
+    typename T_,
+    typename Allocator_ = std::allocator<T_>,
+    typename Stats_ = no_stats>
+class mpsc_cyclic_queue {
+  static_assert(
+      std::is_same_v<std::remove_cv_t<T_>, T_>,
+      "ouroboros::mpsc_cyclic_queue must have a non-const, non-volatile "
+      "value_type");
+  static_assert(
+      std::is_nothrow_move_assignable_v<T_>,
+      "ouroboros::mpsc_cyclic_queue requires a nothrow move assignable "
+      "value_type");
+
+  using container = std::vector<T_, Allocator_>;
+  using flag_container = std::vector<
+      std::atomic<std::size_t>,
+      typename std::allocator_traits<Allocator_>::template rebind_alloc<
+          std::atomic<std::size_t>>>;
+
+ public:
+  using allocator_type = typename container::allocator_type;
+  using stats_type = Stats_;
+  using size_type = std::size_t;
+  using value_type = T_;
+  using reference = T_&;
+  using const_reference = T_ const&;
+  using segment_pair = std::array<segment<T_>, 2>;
+
+  //! \brief A range of slots claimed by a producer. Write the elements into
+  //! the segments and hand the claim to publish().
+  class claim_type {
+   public:
+    constexpr claim_type() noexcept : position_(), segments_() {}
+
+    //! \brief Return the number of claimed slots. Zero for a failed claim.
+    constexpr size_type size() const noexcept {
+      return segments_[0].size() + segments_[1].size();
+    }
+
+    constexpr bool empty() const noexcept { return size() == 0; }
+
+    //! \brief Return the claimed slots as two contiguous segments.
+    constexpr segment_pair const& segments() const noexcept {
+      return segments_;
+    }
+
+    //! \brief Return a reference to claimed slot \p i.
+    constexpr reference operator[](size_type i) const noexcept {
+      auto size1 = segments_[0].size();
+      return i < size1 ? segments_[0][i] : segments_[1][i - size1];
+    }
+
+   private:
+    friend class mpsc_cyclic_queue;
+
+    constexpr claim_type(size_type position, segment_pair segments) noexcept
+        : position_(position), segments_(segments) {}
+
+    size_type position_;
+    segment_pair segments_;
+  };
+
+  //! \brief Create a queue that can hold at least \p c elements.
+  explicit mpsc_cyclic_queue(
+      size_type c, allocator_type const& a = allocator_type())
+      : buf_(internal::ceil_power_of_two(c), a),
+        ready_(buf_.size(), typename flag_container::allocator_type(a)),
+        mask_(buf_.size() - 1),
+        tail_(0),
+        head_(0) {
+    // Position p is published when ready_[p & mask_] equals p + 1.
+    for (auto& r : ready_) {
+      r.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  mpsc_cyclic_queue(mpsc_cyclic_queue const&) = delete;
+
+  mpsc_cyclic_queue& operator=(mpsc_cyclic_queue const&) = delete;
+
+  //! \brief Claim \p n contiguous slots with a single fetch_add on the tail.
+  //! Waits for the consumer when there is not enough space. Producer only.
+  //! \details Undefined behavior if \p n exceeds capacity(). Every claim must
+  //! be published, even when writing its elements fails, because the consumer
+  //! can't read past an unpublished slot.
+  claim_type claim(size_type n) {
+    assert(n <= capacity());
+    size_type pos = tail_.fetch_add(n, std::memory_order_relaxed);
+    if (pos + n - head_.load(std::memory_order_acquire) > capacity()) {
+      auto start = stats_.wait_start();
+      do {
+        stats_.full();
+        std::this_thread::yield();
+      } while (pos + n - head_.load(std::memory_order_acquire) > capacity());
+      stats_.wait_stop(start);
+    }
+    return make_claim(pos, n);
+  }
+
+  //! \brief Claim \p n contiguous slots if there is enough space. Returns an
+  //! empty claim otherwise. Producer only.
+  //! \details Like those of claim(), the slots must always be published.
+  claim_type try_claim(size_type n) {
+    size_type pos = tail_.load(std::memory_order_relaxed);
+    while (true) {
+      if (pos + n - head_.load(std::memory_order_acquire) > capacity()) {
+        stats_.full();
+        return claim_type();
+      }
+      if (tail_.compare_exchange_weak(
+              pos, pos + n, std::memory_order_relaxed)) {
+        return make_claim(pos, n);
+      }
+      stats_.cas_retry();
+    }
+  }
+
+  //! \brief Make the elements of claim \p c available to the consumer.
+  //! Producer only.
+  //! \details Must be called for every claim, also when writing its elements
+  //! threw. The slots that weren't written then hold the elements of a
+  //! previous lap, or value-initialized ones.
+  void publish(claim_type const& c) noexcept {
+    for (size_type i = 0; i < c.size(); ++i) {
+      size_type pos = c.position_ + i;
+      ready_[pos & mask_].store(pos + 1, std::memory_order_release);
+    }
+  }
+
+  //! \brief Add an element to the end of the queue. Returns false if the queue
+  //! is full. Producer only.
+  template <typename U_>
+  bool try_push(U_&& value) {
+    if constexpr (!std::is_nothrow_assignable_v<T_&, U_&&>) {
+      return try_push(value_type(std::forward<U_>(value)));
+    }
+    claim_type c = try_claim(1);
+    if (c.empty()) {
+      return false;
+    }
+    c[0] = std::forward<U_>(value);
+    publish(c);
+    return true;
+  }
+
+  //! \brief Return all published elements from the front of the queue, in
+  //! order, as at most two contiguous segments. The elements remain in the
+  //! queue until they are removed with pop_front(). Consumer only.
+  segment_pair readable_segments() noexcept {
+    size_type head = head_.load(std::memory_order_relaxed);
+    size_type n = 0;
+    while (n < capacity() && ready_[(head + n) & mask_].load(
+                                 std::memory_order_acquire) == head + n + 1) {
+      ++n;
+    }
+    return make_segments(head, n);
+  }
+
+  //! \brief Remove the first \p n elements, returning their slots to the
+  //! producers. Consumer only.
+  //! \details Undefined behavior if \p n exceeds the number of elements that
+  //! were returned by readable_segments().
+  void pop_front(size_type n) noexcept {
+    head_.store(
+        head_.load(std::memory_order_relaxed) + n, std::memory_order_release);
+  }
+
+  //! \brief Remove the first element of the queue and move it into \p value.
+  //! Returns false if no element was published. Consumer only.
+  bool try_pop(value_type& value) {
+    size_type head = head_.load(std::memory_order_relaxed);
+    if (ready_[head & mask_].load(std::memory_order_acquire) != head + 1) {
+      stats_.empty();
+      return false;
+    }
+    value = std::move(buf_[head & mask_]);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  //! \brief Call \p f for each contiguous segment of published elements and
+  //! remove them from the queue. Returns the number of elements consumed.
+  //! Consumer only.
+  template <typename F_>
+  size_type consume(F_&& f) {
+    segment_pair segments = readable_segments();
+    for (auto const& s : segments) {
+      if (!s.empty()) {
+        f(s);
+      }
+    }
+    size_type n = segments[0].size() + segments[1].size();
+    if (n == 0) {
+      stats_.empty();
+    }
+    pop_front(n);
+    return n;
+  }
+
+  //! \brief Return the maximum number of elements the queue can hold.
+  size_type capacity() const noexcept { return buf_.size(); }
+
+  //! \brief Return the approximate number of claimed elements in the queue.
+  size_type size() const noexcept {
+    size_type head = head_.load(std::memory_order_acquire);
+    size_type tail = tail_.load(std::memory_order_acquire);
+    return std::min(tail > head ? tail - head : 0, capacity());
+  }
+
+  //! \brief Return true if the queue is approximately empty.
+  bool empty() const noexcept { return size() == 0; }
+
+  //! \brief Return the statistics policy.
+  stats_type& stats() noexcept { return stats_; }
+
+  //! \brief Return the statistics policy.
+  stats_type const& stats() const noexcept { return stats_; }
+
+ private:
+  segment_pair make_segments(size_type pos, size_type n) noexcept {
+    size_type first = pos & mask_;
+    size_type size1 = std::min(n, capacity() - first);
+    return {{{buf_.data() + first, size1}, {buf_.data(), n - size1}}};
+  }
+
+  claim_type make_claim(size_type pos, size_type n) noexcept {
+    return claim_type(pos, make_segments(pos, n));
+  }
+
+  // Shared and read-only after construction.
+  alignas(internal::cache_line_size) container buf_;
+  flag_container ready_;
+  size_type mask_;
+  Stats_ stats_;
+  // Claimed by producers.
+  alignas(internal::cache_line_size) std::atomic<size_type> tail_;
+  // Written by the consumer.
+  alignas(internal::cache_line_size) std::atomic<size_type> head_;
+};
+
+}  // namespace ouroboros
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "concurrency.hpp"
+#include "mpmc_cyclic_queue.hpp"
+
+namespace ouroboros {
+
+//! \brief A fixed-size pool of preallocated objects that threads acquire and
+//! release without locks or allocations.
+//! \details Pointers to the free objects are kept in an mpmc_cyclic_queue
+//! that is filled when the pool is created. Optionally, each thread keeps a
+//! magazine of up to magazine_size() free objects in front of the queue. A
+//! thread that finds its magazine empty refills half of it from the queue,
+//! and one that finds it full returns half of it. Most acquire() and release()
+//! calls then only touch thread-local memory. Objects cached in the magazines
+//! of other threads can't be acquired, so a pool should hold
+//! magazine_size() extra objects per thread. When a thread exits, its
+//! magazine is returned to the pool and its counters are added to those of
+//! the pool, such that the pool only keeps records of running threads.
+//!
+//! Objects are not reset when they are released.
+template <typename T_, typename Allocator_ = std::allocator<T_>>
+class object_pool {
+  //! \brief The magazine and usage counters of a single thread. The counters
+  //! are only written by their thread, such that counting doesn't cause
+  //! contention.
+  struct alignas(internal::cache_line_size) local {
+    explicit local(std::size_t magazine_size)
+        : magazine(magazine_size), count(0) {}
+
+    std::vector<T_*> magazine;
+    std::size_t count;
+    std::atomic<std::uint64_t> acquired{0};
+    std::atomic<std::uint64_t> released{0};
+    std::atomic<std::uint64_t> exhausted{0};
+  };
+
+  //! \brief The part of the pool that threads keep alive while they return
+  //! their magazine.
+  struct state {
+    state(
+        std::size_t n,
+        std::size_t m,
+        T_ const& prototype,
+        Allocator_ const& a)
+        : objects(n, prototype, a), free(n), magazine_size(m) {}
+
+    std::vector<T_, Allocator_> objects;
+    mpmc_cyclic_queue<T_*> free;
+    std::size_t const magazine_size;
+    std::mutex mutex;
+    std::vector<std::unique_ptr<local>> locals;
+    // The counters of the threads that exited, guarded by the mutex.
+    std::uint64_t acquired = 0;
+    std::uint64_t released = 0;
+    std::uint64_t exhausted = 0;
+  };
+
+ public:
+  using allocator_type = Allocator_;
+  using size_type = std::size_t;
+  using value_type = T_;
+
+  //! \brief Returns an object to its pool when used with std::unique_ptr.
+  class deleter {
+   public:
+    explicit deleter(object_pool* pool = nullptr) noexcept : pool_(pool) {}
+
+    void operator()(T_* p) const { pool_->release(p); }
+
+   private:
+    object_pool* pool_;
+  };
+
+  using unique_ptr = std::unique_ptr<T_, deleter>;
+
+  //! \brief Usage counters of a pool. The values are approximate while
+  //! threads use the pool.
+  struct statistics {
+    //! \brief The number of objects in the pool.
+    size_type capacity;
+    //! \brief The number of acquired objects that were not yet released.
+    size_type in_use;
+    //! \brief The total number of successful acquire() calls.
+    std::uint64_t acquired;
+    //! \brief The total number of release() calls.
+    std::uint64_t released;
+    //! \brief The total number of acquire() calls that found no free object.
+    std::uint64_t exhausted;
+  };
+
+  //! \brief Create a pool of \p n copies of \p prototype. Each thread caches
+  //! up to \p magazine_size free objects. A magazine_size of zero disables the
+  //! caches.
+  explicit object_pool(
+      size_type n,
+      size_type magazine_size = 0,
+      T_ const& prototype = T_(),
+      allocator_type const& a = allocator_type())
+      : state_(std::make_shared<state>(n, magazine_size, prototype, a)) {
+    for (auto& o : state_->objects) {
+      state_->free.try_push(&o);
+    }
+  }
+
+  object_pool(object_pool const&) = delete;
+
+  object_pool& operator=(object_pool const&) = delete;
+
+  //! \brief Return a free object, or nullptr if there is none.
+  T_* acquire() {
+    local& l = local_record();
+    T_* p = nullptr;
+    if (l.count > 0) {
+      p = l.magazine[--l.count];
+    } else if (state_->free.try_pop(p)) {
+      size_type half = l.magazine.size() / 2;
+      while (l.count < half && state_->free.try_pop(l.magazine[l.count])) {
+        ++l.count;
+      }
+    } else {
+      internal::single_writer_increment(l.exhausted);
+      return nullptr;
+    }
+    internal::single_writer_increment(l.acquired);
+    return p;
+  }
+
+  //! \brief Return a free object that is released when the std::unique_ptr is
+  //! destroyed, or an empty std::unique_ptr if there is none.
+  unique_ptr acquire_unique() { return unique_ptr(acquire(), deleter(this)); }
+
+  //! \brief Return \p p, which was acquired from this pool, to the pool.
+  void release(T_* p) {
+    assert(owns(p));
+    local& l = local_record();
+    size_type m = l.magazine.size();
+    if (m == 0) {
+      state_->free.try_push(p);
+    } else {
+      if (l.count == m) {
+        while (l.count > m / 2) {
+          state_->free.try_push(l.magazine[--l.count]);
+        }
+      }
+      l.magazine[l.count++] = p;
+    }
+    internal::single_writer_increment(l.released);
+  }
+
+  //! \brief Return true if \p p points to an object of this pool.
+  bool owns(T_ const* p) const noexcept {
+    auto const& o = state_->objects;
+    return !o.empty() && p >= o.data() && p < o.data() + o.size();
+  }
+
+  //! \brief Return the number of objects in the pool.
+  size_type capacity() const noexcept { return state_->objects.size(); }
+
+  //! \brief Return the maximum number of free objects cached per thread.
+  size_type magazine_size() const noexcept { return state_->magazine_size; }
+
+  //! \brief Return the usage counters, summed over all threads.
+  statistics stats() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    statistics s{
+        capacity(),
+        0,
+        state_->acquired,
+        state_->released,
+        state_->exhausted};
+    for (auto const& l : state_->locals) {
+      s.acquired += l->acquired.load(std::memory_order_relaxed);
+      s.released += l->released.load(std::memory_order_relaxed);
+      s.exhausted += l->exhausted.load(std::memory_order_relaxed);
+    }
+    s.in_use = s.acquired > s.released
+                   ? static_cast<size_type>(s.acquired - s.released)
+                   : 0;
+    return s;
+  }
+
+ private:
+  //! \brief Returns the magazine of a thread to the pool when the thread
+  //! exits, and replaces its record by its counters.
+  struct return_magazine {
+    void operator()(state& s, local& l) const {
+      while (l.count > 0) {
+        s.free.try_push(l.magazine[--l.count]);
+      }
+      std::lock_guard<std::mutex> lock(s.mutex);
+      s.acquired += l.acquired.load(std::memory_order_relaxed);
+      s.released += l.released.load(std::memory_order_relaxed);
+      s.exhausted += l.exhausted.load(std::memory_order_relaxed);
+      internal::erase_record(s.locals, l);
+    }
+  };
+
+  //! \brief Return the record of the calling thread, creating it the first
+  //! time.
+  local& local_record() {
+    return registry_.local(state_, [this]() {
+      auto record = std::make_unique<local>(state_->magazine_size);
+      std::lock_guard<std::mutex> lock(state_->mutex);
+      state_->locals.push_back(std::move(record));
+      return state_->locals.back().get();
+    });
+  }
+
+  std::shared_ptr<state> state_;
+  internal::thread_local_registry<state, local, return_magazine> registry_;
+};
+
+}  // namespace ouroboros
@@ -0,0 +1,273 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// The overloads that take a standard execution policy are opt-in, because
+// <execution> may require linking against a parallel backend, such as TBB.
+#if defined(OUROBOROS_PARALLEL_STD_EXECUTION)
+#include <execution>
+#endif
+
+#include "concurrency.hpp"
+#include "thread_pool.hpp"
+
+namespace ouroboros {
+
+namespace parallel {
+
+//! \brief The default number of bytes per chunk of work.
+inline constexpr std::size_t default_chunk_bytes = 64 * 1024;
+
+}  // namespace parallel
+
+namespace internal {
+
+//! \brief A contiguous part of one of the used segments of a ring.
+template <typename Pointer_>
+struct chunk {
+  Pointer_ first;
+  std::size_t size;
+  //! \brief The index of the first element of the chunk within the ring.
+  std::size_t index;
+};
+
+//! \brief Split \p segments into chunks of about \p chunk_bytes bytes. When
+//! the size of an element divides the size of a cache line, chunk boundaries
+//! are aligned to cache lines, such that no two chunks write to the same
+//! cache line. The chunks are ordered by their index.
+template <typename Segments_>
+auto make_chunks(Segments_ const& segments, std::size_t chunk_bytes) {
+  using pointer = decltype(segments[0].data());
+  using value_type = std::remove_pointer_t<pointer>;
+  constexpr std::size_t line_elements =
+      sizeof(value_type) < cache_line_size &&
+              cache_line_size % sizeof(value_type) == 0
+          ? cache_line_size / sizeof(value_type)
+          : 1;
+  std::size_t chunk_size =
+      std::max<std::size_t>(chunk_bytes / sizeof(value_type), 1);
+  chunk_size = (chunk_size + line_elements - 1) / line_elements * line_elements;
+
+  std::vector<chunk<pointer>> chunks;
+  std::size_t index = 0;
+  for (auto const& s : segments) {
+    std::size_t offset = 0;
+    if (line_elements > 1 && s.size() > chunk_size) {
+      // The first chunk ends on a cache line boundary.
+      auto address = reinterpret_cast<std::uintptr_t>(s.data());
+      std::size_t misalignment =
+          (cache_line_size - address % cache_line_size) % cache_line_size /
+          sizeof(value_type);
+      if (misalignment > 0) {
+        chunks.push_back({s.data(), misalignment, index});
+        offset = misalignment;
+      }
+    }
+    for (; offset < s.size(); offset += chunk_size) {
+      chunks.push_back({s.data() + offset,
+                        std::min(chunk_size, s.size() - offset),
+                        index + offset});
+    }
+    index += s.size();
+  }
+  return chunks;
+}
+
+//! \brief Call \p f(chunk) for each chunk of the ring \p r on \p pool.
+template <typename Ring_, typename F_>
+void for_each_chunk(
+    thread_pool& pool, Ring_& r, std::size_t chunk_bytes, F_&& f) {
+  auto chunks = make_chunks(r.used_segments(), chunk_bytes);
+  pool.parallel_for(
+      std::size_t{0}, chunks.size(), std::size_t{1},
+      [&chunks, &f](std::size_t i) { f(chunks[i]); });
+}
+
+}  // namespace internal
+
+//! \brief Parallel versions of standard algorithms for cyclic_deque.
+//! \details The used segments of a ring are split into chunks that are aligned
+//! to cache lines and processed on a thread_pool. Reductions combine the
+//! results of the chunks in the order of the ring, such that the reduction
+//! operation only has to be associative, not commutative.
+namespace parallel {
+
+//! \brief Call \p f(element) for each element of \p r.
+template <typename Ring_, typename F_>
+void for_each(
+    thread_pool& pool,
+    Ring_& r,
+    F_ f,
+    std::size_t chunk_bytes = default_chunk_bytes) {
+  internal::for_each_chunk(pool, r, chunk_bytes, [&f](auto const& c) {
+    std::for_each(c.first, c.first + c.size, f);
+  });
+}
+
+//! \brief Assign \p op(r[i]) to \p out[i] for each element of \p r.
+template <typename Ring_, typename RandomAccessIterator_, typename F_>
+void transform(
+    thread_pool& pool,
+    Ring_& r,
+    RandomAccessIterator_ out,
+    F_ op,
+    std::size_t chunk_bytes = default_chunk_bytes) {
+  internal::for_each_chunk(
+      pool, r, chunk_bytes, [&out, &op](auto const& c) {
+        auto o = out + static_cast<
+                           typename std::iterator_traits<
+                               RandomAccessIterator_>::difference_type>(
+                           c.index);
+        std::transform(c.first, c.first + c.size, o, op);
+      });
+}
+
+//! \brief Return \p init combined with \p transform(element) for each element
+//! of \p r using \p reduce, in order.
+template <typename Ring_, typename T_, typename Reduce_, typename Transform_>
+T_ transform_reduce(
+    thread_pool& pool,
+    Ring_& r,
+    T_ init,
+    Reduce_ reduce,
+    Transform_ transform,
+    std::size_t chunk_bytes = default_chunk_bytes) {
+  auto chunks = internal::make_chunks(r.used_segments(), chunk_bytes);
+  std::vector<std::optional<T_>> partials(chunks.size());
+  pool.parallel_for(
+      std::size_t{0}, chunks.size(), std::size_t{1}, [&](std::size_t i) {
+        auto const& c = chunks[i];
+        T_ p = transform(c.first[0]);
+        for (std::size_t j = 1; j < c.size; ++j) {
+          p = reduce(std::move(p), transform(c.first[j]));
+        }
+        partials[i].emplace(std::move(p));
+      });
+  for (auto& p : partials) {
+    init = reduce(std::move(init), std::move(*p));
+  }
+  return init;
+}
+
+//! \brief Return \p init combined with each element of \p r using \p op, in
+//! order.
+template <typename Ring_, typename T_, typename Op_ = std::plus<>>
+T_ reduce(
+    thread_pool& pool,
+    Ring_& r,
+    T_ init,
+    Op_ op = Op_(),
+    std::size_t chunk_bytes = default_chunk_bytes) {
+  return transform_reduce(
+      pool, r, std::move(init), op,
+      [](auto const& v) -> T_ { return v; }, chunk_bytes);
+}
+
+//! \brief Sort the elements of \p r by \p comp. The order of equal elements is
+//! not preserved.
+//! \details The chunks are sorted in parallel and merged pairwise, in rounds
+//! that double the length of the sorted runs.
+template <typename Ring_, typename Compare_ = std::less<>>
+void sort(
+    thread_pool& pool,
+    Ring_& r,
+    Compare_ comp = Compare_(),
+    std::size_t chunk_bytes = default_chunk_bytes) {
+  auto chunks = internal::make_chunks(r.used_segments(), chunk_bytes);
+  pool.parallel_for(
+      std::size_t{0}, chunks.size(), std::size_t{1}, [&](std::size_t i) {
+        std::sort(chunks[i].first, chunks[i].first + chunks[i].size, comp);
+      });
+
+  // The start index of each sorted run, followed by the size of the ring.
+  std::vector<std::size_t> runs;
+  for (auto const& c : chunks) {
+    runs.push_back(c.index);
+  }
+  runs.push_back(r.size());
+  auto begin = r.begin();
+  using difference_type = typename decltype(begin)::difference_type;
+  while (runs.size() > 2) {
+    std::size_t pairs = (runs.size() - 1) / 2;
+    pool.parallel_for(
+        std::size_t{0}, pairs, std::size_t{1}, [&](std::size_t i) {
+          std::inplace_merge(
+              begin + static_cast<difference_type>(runs[2 * i]),
+              begin + static_cast<difference_type>(runs[2 * i + 1]),
+              begin + static_cast<difference_type>(runs[2 * i + 2]),
+              comp);
+        });
+    std::vector<std::size_t> merged;
+    for (std::size_t i = 0; i < runs.size(); i += 2) {
+      merged.push_back(runs[i]);
+    }
+    if (merged.back() != runs.back()) {
+      merged.push_back(runs.back());
+    }
+    runs = std::move(merged);
+  }
+}
+
+#if defined(OUROBOROS_PARALLEL_STD_EXECUTION)
+
+//! \brief Call \p f(element) for each element of \p r using the standard
+//! execution \p policy on each used segment.
+template <typename ExecutionPolicy_, typename Ring_, typename F_>
+std::enable_if_t<
+    std::is_execution_policy_v<std::decay_t<ExecutionPolicy_>>>
+for_each(ExecutionPolicy_&& policy, Ring_& r, F_ f) {
+  for (auto const& s : r.used_segments()) {
+    std::for_each(policy, s.begin(), s.end(), f);
+  }
+}
+
+//! \brief Assign \p op(r[i]) to \p out[i] for each element of \p r using the
+//! standard execution \p policy on each used segment.
+template <
+    typename ExecutionPolicy_,
+    typename Ring_,
+    typename RandomAccessIterator_,
+    typename F_>
+std::enable_if_t<
+    std::is_execution_policy_v<std::decay_t<ExecutionPolicy_>>>
+transform(
+    ExecutionPolicy_&& policy, Ring_& r, RandomAccessIterator_ out, F_ op) {
+  for (auto const& s : r.used_segments()) {
+    out = std::transform(policy, s.begin(), s.end(), out, op);
+  }
+}
+
+//! \brief Sort the elements of \p r by \p comp using the standard execution
+//! \p policy. Both segments are sorted separately and then merged.
+template <
+    typename ExecutionPolicy_,
+    typename Ring_,
+    typename Compare_ = std::less<>>
+std::enable_if_t<
+    std::is_execution_policy_v<std::decay_t<ExecutionPolicy_>>>
+sort(ExecutionPolicy_&& policy, Ring_& r, Compare_ comp = Compare_()) {
+  auto segments = r.used_segments();
+  for (auto const& s : segments) {
+    std::sort(policy, s.begin(), s.end(), comp);
+  }
+  auto middle = r.begin() + static_cast<typename Ring_::difference_type>(
+                                segments[0].size());
+  std::inplace_merge(policy, r.begin(), middle, r.end(), comp);
+}
+
+// Reductions are not provided for execution policies because std::reduce may
+// reorder the operands.
+
+#endif
+
+}  // namespace parallel
+
+}  // namespace ouroboros
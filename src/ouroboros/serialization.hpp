@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "cyclic_deque.hpp"
+
+namespace ouroboros {
+
+//! \brief The header that precedes the contents of a serialized cyclic_deque.
+//! \details All fields, and the elements that follow, are stored in native
+//! byte order. A snapshot written on a machine with a different byte order is
+//! rejected because its magic number won't match.
+struct snapshot_header {
+  //! \brief The current version of the format.
+  static constexpr std::uint32_t current_version = 1;
+  //! \brief "OURO" when read as a big-endian number.
+  static constexpr std::uint32_t magic_number = 0x4f55524f;
+
+  std::uint32_t magic;
+  std::uint32_t version;
+  std::uint64_t element_size;
+  std::uint64_t capacity;
+  std::uint64_t size;
+};
+
+static_assert(sizeof(snapshot_header) == 32);
+
+namespace internal {
+
+template <typename T_>
+constexpr void static_assert_serializable_value_type() {
+  static_assert(
+      std::is_trivially_copyable_v<T_>,
+      "ouroboros::serialize requires a trivially copyable value_type");
+}
+
+template <typename T_>
+void validate_snapshot_header(snapshot_header const& header) {
+  if (header.magic != snapshot_header::magic_number) {
+    throw std::runtime_error("ouroboros::deserialize: invalid magic number");
+  }
+  if (header.version != snapshot_header::current_version) {
+    throw std::runtime_error(
+        "ouroboros::deserialize: unsupported version (which is " +
+        std::to_string(header.version) + ")");
+  }
+  if (header.element_size != sizeof(T_)) {
+    throw std::runtime_error(
+        "ouroboros::deserialize: header.element_size (which is " +
+        std::to_string(header.element_size) + ") != sizeof(T_) (which is " +
+        std::to_string(sizeof(T_)) + ")");
+  }
+  if (header.size > header.capacity) {
+    throw std::runtime_error(
+        "ouroboros::deserialize: header.size (which is " +
+        std::to_string(header.size) + ") > header.capacity (which is " +
+        std::to_string(header.capacity) + ")");
+  }
+  if (header.capacity > std::numeric_limits<std::size_t>::max() / sizeof(T_)) {
+    throw std::runtime_error(
+        "ouroboros::deserialize: header.capacity (which is " +
+        std::to_string(header.capacity) + ") is too large");
+  }
+}
+
+[[noreturn]] inline void throw_truncated_snapshot() {
+  throw std::runtime_error("ouroboros::deserialize: the snapshot is truncated");
+}
+
+}  // namespace internal
+
+//! \brief Write a snapshot of \p ring using \p writer.
+//! \details The writer is invoked as writer(void const* data, std::size_t
+//! bytes). It is called once for the snapshot_header and at most twice for the
+//! contents of \p ring, once per contiguous segment.
+template <typename T_, typename Allocator_, typename Writer_>
+void serialize(cyclic_deque<T_, Allocator_> const& ring, Writer_&& writer) {
+  internal::static_assert_serializable_value_type<T_>();
+
+  snapshot_header header{
+      snapshot_header::magic_number,
+      snapshot_header::current_version,
+      sizeof(T_),
+      ring.capacity(),
+      ring.size()};
+  writer(static_cast<void const*>(&header), sizeof(header));
+  for (auto const& s : ring.used_segments()) {
+    if (!s.empty()) {
+      writer(static_cast<void const*>(s.data()), s.size_bytes());
+    }
+  }
+}
+
+//! \brief Create a cyclic_deque from a snapshot that is read using \p reader.
+//! \details The reader is invoked as reader(void* data, std::size_t bytes) and
+//! should read exactly \p bytes or throw. It is called once for the
+//! snapshot_header and once for the contents of the cyclic_deque. Throws an
+//! std::runtime_error when the header doesn't describe a cyclic_deque of
+//! value_type \p T_.
+template <
+    typename T_,
+    typename Allocator_ = std::allocator<T_>,
+    typename Reader_,
+    std::enable_if_t<std::is_invocable_v<Reader_&, void*, std::size_t>, int> =
+        0>
+cyclic_deque<T_, Allocator_> deserialize(
+    Reader_&& reader, Allocator_ const& a = Allocator_()) {
+  internal::static_assert_serializable_value_type<T_>();
+
+  snapshot_header header;
+  reader(static_cast<void*>(&header), sizeof(header));
+  internal::validate_snapshot_header<T_>(header);
+
+  using size_type = typename cyclic_deque<T_, Allocator_>::size_type;
+  cyclic_deque<T_, Allocator_> ring(
+      static_cast<size_type>(header.capacity),
+      static_cast<size_type>(header.size),
+      a);
+  // A newly created cyclic_deque starts at the beginning of its buffer. Its
+  // contents are a single segment.
+  auto s = ring.used_segments()[0];
+  if (!s.empty()) {
+    reader(static_cast<void*>(s.data()), s.size_bytes());
+  }
+  return ring;
+}
+
+//! \brief Create a cyclic_deque from a snapshot stored in memory, such as a
+//! memory-mapped file. The contents are copied into the new cyclic_deque using
+//! a single copy.
+//! \details Throws an std::runtime_error when the memory is too small to
+//! contain the snapshot or when the header doesn't describe a cyclic_deque of
+//! value_type \p T_. Both are checked before the cyclic_deque is allocated.
+template <typename T_, typename Allocator_ = std::allocator<T_>>
+cyclic_deque<T_, Allocator_> deserialize(
+    void const* data, std::size_t bytes, Allocator_ const& a = Allocator_()) {
+  internal::static_assert_serializable_value_type<T_>();
+
+  snapshot_header header;
+  if (bytes < sizeof(header)) {
+    internal::throw_truncated_snapshot();
+  }
+  std::memcpy(&header, data, sizeof(header));
+  internal::validate_snapshot_header<T_>(header);
+  // The size can't overflow, because it doesn't exceed the validated capacity.
+  if (bytes - sizeof(header) < header.size * sizeof(T_)) {
+    internal::throw_truncated_snapshot();
+  }
+
+  auto const* first = static_cast<unsigned char const*>(data);
+  auto const* last = first + bytes;
+  return deserialize<T_, Allocator_>(
+      [&first, last](void* output, std::size_t n) {
+        if (static_cast<std::size_t>(last - first) < n) {
+          internal::throw_truncated_snapshot();
+        }
+        std::memcpy(output, first, n);
+        first += n;
+      },
+      a);
+}
+
+}  // namespace ouroboros
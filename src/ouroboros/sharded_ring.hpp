@@ -0,0 +1,222 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "concurrency.hpp"
+#include "spsc_cyclic_queue.hpp"
+
+namespace ouroboros {
+
+//! \brief A multi-producer single-consumer ring that gives each producer
+//! thread a shard of its own.
+//! \details A shard is an spsc_cyclic_queue that is created the first time a
+//! thread pushes into the ring and found through thread-local storage after
+//! that. Producers never write to shared cache lines, so the cost of a push
+//! doesn't depend on the number of producers. A shard lives as long as the
+//! ring. When its thread exits, the shard is retired, and once the consumer
+//! has drained it, it is reused by the next new producer thread. The number of
+//! producer threads with a shard at the same time is limited to max_shards().
+//!
+//! The consumer either drains the shards round-robin with consume(), or merges
+//! them with consume_ordered() when the elements of each shard are ordered by
+//! a key, such as a timestamp.
+template <typename T_, typename Allocator_ = std::allocator<T_>>
+class sharded_ring {
+  //! \brief The life cycle of a shard. The status moves from active to
+  //! retired when the thread of the shard exits, from retired to drained when
+  //! the consumer finds the shard empty, and back to active when another
+  //! thread takes the shard over.
+  enum class shard_status { active, retired, drained };
+
+  struct alignas(internal::cache_line_size) shard {
+    shard(std::size_t c, Allocator_ const& a)
+        : queue(c, a), status(shard_status::active) {}
+
+    spsc_cyclic_queue<T_, Allocator_> queue;
+    // An element popped by consume_ordered() that wasn't consumed yet.
+    std::optional<T_> next;
+    std::atomic<shard_status> status;
+  };
+
+  //! \brief The shards, which threads find through a thread_local_registry.
+  struct state {
+    explicit state(std::size_t max_shards) : shards(max_shards) {}
+
+    // Shards are only added and published through count_.
+    std::vector<std::unique_ptr<shard>> shards;
+    std::mutex mutex;
+  };
+
+  //! \brief Retires the shard of a thread when the thread exits.
+  struct retire_shard {
+    void operator()(state&, shard& s) const noexcept {
+      // Publishes the last elements pushed by the thread to the consumer.
+      s.status.store(shard_status::retired, std::memory_order_release);
+    }
+  };
+
+ public:
+  using allocator_type = Allocator_;
+  using size_type = std::size_t;
+  using value_type = T_;
+
+  //! \brief Create a ring for up to \p max_shards producer threads, each with a
+  //! shard that holds \p shard_capacity elements.
+  sharded_ring(
+      size_type shard_capacity,
+      size_type max_shards,
+      allocator_type const& a = allocator_type())
+      : shard_capacity_(shard_capacity),
+        allocator_(a),
+        state_(std::make_shared<state>(max_shards)),
+        count_(0),
+        start_(0) {}
+
+  sharded_ring(sharded_ring const&) = delete;
+
+  sharded_ring& operator=(sharded_ring const&) = delete;
+
+  //! \brief Add an element to the shard of the calling thread. Returns false
+  //! if the shard is full. Throws std::length_error when the calling thread
+  //! has no shard yet, max_shards() shards exist and none of them is drained.
+  template <typename U_>
+  bool try_push(U_&& value) {
+    return local_shard().queue.try_push(std::forward<U_>(value));
+  }
+
+  //! \brief Call \p f(value) for up to \p max_per_shard elements of each
+  //! shard, visiting the shards round-robin. The first shard visited rotates
+  //! between calls. Returns the number of elements consumed. Consumer only.
+  template <typename F_>
+  size_type consume(F_&& f, size_type max_per_shard = size_type(-1)) {
+    size_type n = count_.load(std::memory_order_acquire);
+    if (n == 0) {
+      return 0;
+    }
+    size_type consumed = 0;
+    value_type value;
+    for (size_type i = 0; i < n; ++i) {
+      shard& s = *state_->shards[(start_ + i) % n];
+      size_type j = 0;
+      if (s.next && j < max_per_shard) {
+        f(std::move(*s.next));
+        s.next.reset();
+        ++j;
+      }
+      for (; j < max_per_shard && s.queue.try_pop(value); ++j) {
+        f(std::move(value));
+      }
+      consumed += j;
+      release_if_drained(s);
+    }
+    start_ = (start_ + 1) % n;
+    return consumed;
+  }
+
+  //! \brief Call \p f(value) for up to \p max available elements in the order
+  //! of \p key(value). Returns the number of elements consumed. Consumer only.
+  //! \details The elements of each shard must be ordered by key. The shards are
+  //! merged by repeatedly consuming the element with the smallest key among
+  //! the first elements of all shards. Elements that are pushed while the
+  //! merge is running may have a smaller key than elements that were already
+  //! consumed.
+  template <typename Key_, typename F_>
+  size_type consume_ordered(
+      Key_&& key, F_&& f, size_type max = size_type(-1)) {
+    size_type n = count_.load(std::memory_order_acquire);
+    size_type consumed = 0;
+    for (; consumed < max; ++consumed) {
+      shard* min = nullptr;
+      for (size_type i = 0; i < n; ++i) {
+        shard& s = *state_->shards[i];
+        if (!s.next) {
+          value_type value;
+          if (!s.queue.try_pop(value)) {
+            continue;
+          }
+          s.next.emplace(std::move(value));
+        }
+        if (min == nullptr || key(*s.next) < key(*min->next)) {
+          min = &s;
+        }
+      }
+      if (min == nullptr) {
+        break;
+      }
+      f(std::move(*min->next));
+      min->next.reset();
+    }
+    for (size_type i = 0; i < n; ++i) {
+      release_if_drained(*state_->shards[i]);
+    }
+    return consumed;
+  }
+
+  //! \brief Return the number of shards that were created. Each is used by at
+  //! most one producer thread at a time.
+  size_type shards() const noexcept {
+    return count_.load(std::memory_order_acquire);
+  }
+
+  //! \brief Return the maximum number of shards.
+  size_type max_shards() const noexcept { return state_->shards.size(); }
+
+  //! \brief Return the capacity of each shard.
+  size_type shard_capacity() const noexcept { return shard_capacity_; }
+
+ private:
+  //! \brief Return the shard of the calling thread, creating it the first time.
+  shard& local_shard() {
+    return registry_.local(state_, [this]() { return add_shard(); });
+  }
+
+  //! \brief Mark a retired shard as drained once it is empty. Consumer only,
+  //! because only the consumer knows whether next holds an element.
+  static void release_if_drained(shard& s) noexcept {
+    // The acquire pairs with retire_shard, after which the queue no longer
+    // changes on the producer side.
+    if (s.status.load(std::memory_order_acquire) == shard_status::retired &&
+        !s.next && s.queue.empty()) {
+      s.status.store(shard_status::drained, std::memory_order_release);
+    }
+  }
+
+  //! \brief Take over a drained shard, or create a new one.
+  shard* add_shard() {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    auto& shards = state_->shards;
+    size_type n = count_.load(std::memory_order_relaxed);
+    for (size_type i = 0; i < n; ++i) {
+      // The acquire pairs with release_if_drained().
+      if (shards[i]->status.load(std::memory_order_acquire) ==
+          shard_status::drained) {
+        shards[i]->status.store(
+            shard_status::active, std::memory_order_relaxed);
+        return shards[i].get();
+      }
+    }
+    if (n == shards.size()) {
+      throw std::length_error("ouroboros::sharded_ring: too many producers");
+    }
+    shards[n] = std::make_unique<shard>(shard_capacity_, allocator_);
+    count_.store(n + 1, std::memory_order_release);
+    return shards[n].get();
+  }
+
+  // Shared and read-only after construction.
+  size_type const shard_capacity_;
+  allocator_type const allocator_;
+  std::shared_ptr<state> const state_;
+  internal::thread_local_registry<state, shard, retire_shard> registry_;
+  alignas(internal::cache_line_size) std::atomic<size_type> count_;
+  // Written by the consumer.
+  alignas(internal::cache_line_size) size_type start_;
+};
+
+}  // namespace ouroboros
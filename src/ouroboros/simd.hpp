@@ -0,0 +1,568 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+// The vector kernels use the vector extensions and the target attribute of GCC
+// and Clang. Other compilers and architectures use the scalar kernels.
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define OUROBOROS_SIMD_X86
+#endif
+
+namespace ouroboros {
+
+namespace simd {
+
+//! \brief The instruction sets used by the vector kernels, in increasing order
+//! of vector width.
+enum class level { scalar, sse2, avx2, avx512 };
+
+}  // namespace simd
+
+namespace internal {
+
+//! \brief Return the widest instruction set supported by the processor.
+inline simd::level detect_simd_level() noexcept {
+#if defined(OUROBOROS_SIMD_X86)
+  __builtin_cpu_init();
+  // The 8-bit and 16-bit lanes of 512-bit vectors require AVX-512BW.
+  if (__builtin_cpu_supports("avx512f") &&
+      __builtin_cpu_supports("avx512bw")) {
+    return simd::level::avx512;
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return simd::level::avx2;
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return simd::level::sse2;
+  }
+#endif
+  return simd::level::scalar;
+}
+
+inline std::atomic<simd::level>& simd_level() noexcept {
+  static std::atomic<simd::level> l{detect_simd_level()};
+  return l;
+}
+
+template <typename T_>
+inline constexpr bool is_simd_value_v =
+    (std::is_integral_v<T_> && !std::is_same_v<T_, bool>) ||
+    std::is_same_v<T_, float> || std::is_same_v<T_, double>;
+
+//! \brief The lane type of the arithmetic on values of type T_. Integers are
+//! added and multiplied as unsigned integers, which wrap around instead of
+//! overflowing.
+template <typename T_, bool = std::is_integral_v<T_>>
+struct simd_lane {
+  using type = T_;
+};
+
+template <typename T_>
+struct simd_lane<T_, true> {
+  using type = std::make_unsigned_t<T_>;
+};
+
+template <typename T_>
+using simd_lane_t = typename simd_lane<T_>::type;
+
+//! \brief The type of the scalar arithmetic on values of type T_: the lane
+//! type, but at least unsigned int, such that small unsigned integers aren't
+//! promoted to int.
+template <typename T_>
+using simd_scalar_t = decltype(0u + simd_lane_t<T_>());
+
+//! \brief Return \p v as simd_scalar_t.
+template <typename T_>
+constexpr simd_scalar_t<T_> simd_widen(T_ v) noexcept {
+  return static_cast<simd_scalar_t<T_>>(v);
+}
+
+#if defined(OUROBOROS_SIMD_X86)
+
+#define OUROBOROS_SIMD_INLINE __attribute__((always_inline)) inline
+
+//! \brief A vector of Bytes_ / sizeof(T_) lanes of type T_.
+template <typename T_, std::size_t Bytes_>
+struct simd_vector {
+  typedef T_ type __attribute__((vector_size(Bytes_)));
+};
+
+template <typename T_, std::size_t Bytes_>
+using simd_vector_t = typename simd_vector<T_, Bytes_>::type;
+
+// Vectors are passed by reference, because passing them by value depends on
+// the instruction set.
+template <typename Vector_, typename T_>
+OUROBOROS_SIMD_INLINE void simd_load(Vector_& v, T_ const* p) noexcept {
+  std::memcpy(&v, p, sizeof(Vector_));
+}
+
+template <typename Vector_, typename T_>
+OUROBOROS_SIMD_INLINE void simd_store(T_* p, Vector_ const& v) noexcept {
+  std::memcpy(p, &v, sizeof(Vector_));
+}
+
+//! \brief Return the number of elements before \p p reaches an address that
+//! is aligned to Bytes_, at most \p n.
+template <std::size_t Bytes_, typename T_>
+OUROBOROS_SIMD_INLINE std::size_t simd_head(
+    T_ const* p, std::size_t n) noexcept {
+  auto address = reinterpret_cast<std::uintptr_t>(p);
+  return std::min(n, (Bytes_ - address % Bytes_) % Bytes_ / sizeof(T_));
+}
+
+//! \brief Instantiate the kernel \p k for each instruction set. The target
+//! attribute lets the compiler emit the instructions of the wider set for the
+//! inlined kernel, without requiring them for the rest of the program.
+template <typename Kernel_>
+__attribute__((target("avx512f,avx512bw"))) auto simd_run_avx512(
+    Kernel_ const& k) {
+  return k.template run<64>();
+}
+
+template <typename Kernel_>
+__attribute__((target("avx2"))) auto simd_run_avx2(Kernel_ const& k) {
+  return k.template run<32>();
+}
+
+template <typename Kernel_>
+__attribute__((target("sse2"))) auto simd_run_sse2(Kernel_ const& k) {
+  return k.template run<16>();
+}
+
+#endif
+
+//! \brief Run kernel \p k with the active instruction set.
+template <typename Kernel_>
+auto simd_dispatch(Kernel_ const& k) {
+#if defined(OUROBOROS_SIMD_X86)
+  switch (simd_level().load(std::memory_order_relaxed)) {
+    case simd::level::avx512:
+      return simd_run_avx512(k);
+    case simd::level::avx2:
+      return simd_run_avx2(k);
+    case simd::level::sse2:
+      return simd_run_sse2(k);
+    case simd::level::scalar:
+      break;
+  }
+#endif
+  return k.scalar();
+}
+
+// Each kernel handles the elements before the first aligned address and the
+// elements after the last full vector with scalar code. The vector loops keep
+// two accumulators to hide the latency of the additions.
+
+template <typename T_>
+struct sum_kernel {
+  T_ const* p;
+  std::size_t n;
+
+  T_ scalar() const noexcept {
+    simd_scalar_t<T_> s = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      s += simd_widen(p[i]);
+    }
+    return static_cast<T_>(s);
+  }
+
+#if defined(OUROBOROS_SIMD_X86)
+  template <std::size_t Bytes_>
+  OUROBOROS_SIMD_INLINE T_ run() const noexcept {
+    using vector = simd_vector_t<simd_lane_t<T_>, Bytes_>;
+    constexpr std::size_t lanes = Bytes_ / sizeof(T_);
+    std::size_t i = simd_head<Bytes_>(p, n);
+    auto s = simd_widen(sum_kernel{p, i}.scalar());
+    vector a0 = {};
+    vector a1 = {};
+    vector v0;
+    vector v1;
+    for (; i + 2 * lanes <= n; i += 2 * lanes) {
+      simd_load(v0, p + i);
+      simd_load(v1, p + i + lanes);
+      a0 += v0;
+      a1 += v1;
+    }
+    for (; i + lanes <= n; i += lanes) {
+      simd_load(v0, p + i);
+      a0 += v0;
+    }
+    a0 += a1;
+    for (std::size_t l = 0; l < lanes; ++l) {
+      s += a0[l];
+    }
+    return static_cast<T_>(s + simd_widen(sum_kernel{p + i, n - i}.scalar()));
+  }
+#endif
+};
+
+template <typename T_>
+struct dot_kernel {
+  T_ const* a;
+  T_ const* b;
+  std::size_t n;
+
+  T_ scalar() const noexcept {
+    simd_scalar_t<T_> s = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      s += simd_widen(a[i]) * simd_widen(b[i]);
+    }
+    return static_cast<T_>(s);
+  }
+
+#if defined(OUROBOROS_SIMD_X86)
+  template <std::size_t Bytes_>
+  OUROBOROS_SIMD_INLINE T_ run() const noexcept {
+    using vector = simd_vector_t<simd_lane_t<T_>, Bytes_>;
+    constexpr std::size_t lanes = Bytes_ / sizeof(T_);
+    // Only the loads of a can be aligned.
+    std::size_t i = simd_head<Bytes_>(a, n);
+    auto s = simd_widen(dot_kernel{a, b, i}.scalar());
+    vector a0 = {};
+    vector a1 = {};
+    vector x0;
+    vector y0;
+    vector x1;
+    vector y1;
+    for (; i + 2 * lanes <= n; i += 2 * lanes) {
+      simd_load(x0, a + i);
+      simd_load(y0, b + i);
+      simd_load(x1, a + i + lanes);
+      simd_load(y1, b + i + lanes);
+      a0 += x0 * y0;
+      a1 += x1 * y1;
+    }
+    for (; i + lanes <= n; i += lanes) {
+      simd_load(x0, a + i);
+      simd_load(y0, b + i);
+      a0 += x0 * y0;
+    }
+    a0 += a1;
+    for (std::size_t l = 0; l < lanes; ++l) {
+      s += a0[l];
+    }
+    return static_cast<T_>(
+        s + simd_widen(dot_kernel{a + i, b + i, n - i}.scalar()));
+  }
+#endif
+};
+
+//! \brief Returns the minimum and the maximum. Undefined behavior if \p n is
+//! zero.
+template <typename T_>
+struct minmax_kernel {
+  T_ const* p;
+  std::size_t n;
+
+  std::pair<T_, T_> scalar() const noexcept {
+    std::pair<T_, T_> m{p[0], p[0]};
+    for (std::size_t i = 1; i < n; ++i) {
+      m.first = p[i] < m.first ? p[i] : m.first;
+      m.second = m.second < p[i] ? p[i] : m.second;
+    }
+    return m;
+  }
+
+#if defined(OUROBOROS_SIMD_X86)
+  template <std::size_t Bytes_>
+  OUROBOROS_SIMD_INLINE std::pair<T_, T_> run() const noexcept {
+    using vector = simd_vector_t<T_, Bytes_>;
+    constexpr std::size_t lanes = Bytes_ / sizeof(T_);
+    std::size_t i = simd_head<Bytes_>(p, n);
+    if (n - i < lanes) {
+      return scalar();
+    }
+    vector lo;
+    simd_load(lo, p + i);
+    vector hi = lo;
+    vector v;
+    for (i += lanes; i + lanes <= n; i += lanes) {
+      simd_load(v, p + i);
+      lo = v < lo ? v : lo;
+      hi = hi < v ? v : hi;
+    }
+    std::pair<T_, T_> m{lo[0], hi[0]};
+    for (std::size_t l = 1; l < lanes; ++l) {
+      m.first = lo[l] < m.first ? lo[l] : m.first;
+      m.second = m.second < hi[l] ? hi[l] : m.second;
+    }
+    // The head and the tail.
+    std::size_t head = simd_head<Bytes_>(p, n);
+    for (std::size_t j = 0; j < head; ++j) {
+      m.first = p[j] < m.first ? p[j] : m.first;
+      m.second = m.second < p[j] ? p[j] : m.second;
+    }
+    for (; i < n; ++i) {
+      m.first = p[i] < m.first ? p[i] : m.first;
+      m.second = m.second < p[i] ? p[i] : m.second;
+    }
+    return m;
+  }
+#endif
+};
+
+template <typename T_>
+struct count_kernel {
+  T_ const* p;
+  std::size_t n;
+  T_ value;
+
+  std::size_t scalar() const noexcept {
+    std::size_t c = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      c += p[i] == value ? 1 : 0;
+    }
+    return c;
+  }
+
+#if defined(OUROBOROS_SIMD_X86)
+  template <std::size_t Bytes_>
+  OUROBOROS_SIMD_INLINE std::size_t run() const noexcept {
+    using vector = simd_vector_t<T_, Bytes_>;
+    // A comparison returns a vector of signed integers of the same width,
+    // with all bits set in the lanes that are equal.
+    using mask = decltype(vector{} == vector{});
+    using lane = std::remove_cv_t<std::remove_reference_t<decltype(
+        std::declval<mask&>()[0])>>;
+    constexpr std::size_t lanes = Bytes_ / sizeof(T_);
+    // The number of vectors after which a lane of the counter could overflow.
+    constexpr std::size_t flush = static_cast<std::size_t>(std::min<
+        std::uint64_t>(
+        static_cast<std::uint64_t>(std::numeric_limits<lane>::max()),
+        std::uint64_t(1) << 20));
+    std::size_t i = simd_head<Bytes_>(p, n);
+    std::size_t c = count_kernel{p, i, value}.scalar();
+    vector x = vector{} + value;
+    vector v;
+    while (i + lanes <= n) {
+      mask counts = {};
+      for (std::size_t k = 0; k < flush && i + lanes <= n; ++k, i += lanes) {
+        simd_load(v, p + i);
+        counts -= v == x;
+      }
+      for (std::size_t l = 0; l < lanes; ++l) {
+        c += static_cast<std::size_t>(counts[l]);
+      }
+    }
+    return c + count_kernel{p + i, n - i, value}.scalar();
+  }
+#endif
+};
+
+template <typename T_>
+struct scale_kernel {
+  T_* p;
+  std::size_t n;
+  T_ factor;
+
+  void scalar() const noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+      p[i] = static_cast<T_>(simd_widen(p[i]) * simd_widen(factor));
+    }
+  }
+
+#if defined(OUROBOROS_SIMD_X86)
+  template <std::size_t Bytes_>
+  OUROBOROS_SIMD_INLINE void run() const noexcept {
+    using vector = simd_vector_t<simd_lane_t<T_>, Bytes_>;
+    constexpr std::size_t lanes = Bytes_ / sizeof(T_);
+    std::size_t i = simd_head<Bytes_>(p, n);
+    scale_kernel{p, i, factor}.scalar();
+    vector f = vector{} + static_cast<simd_lane_t<T_>>(factor);
+    vector v;
+    for (; i + lanes <= n; i += lanes) {
+      simd_load(v, p + i);
+      v *= f;
+      simd_store(p + i, v);
+    }
+    scale_kernel{p + i, n - i, factor}.scalar();
+  }
+#endif
+};
+
+}  // namespace internal
+
+//! \brief Vectorized reductions and transforms over arrays and over the
+//! segments of a ring, such as a cyclic_deque.
+//! \details The value type must be an integer other than bool, float or
+//! double. The kernels use the widest instruction set that the processor
+//! supports, SSE2, AVX2 or AVX-512, which is detected once at run time. The
+//! rest of the program doesn't need to be compiled for these instruction sets.
+//! Each kernel processes the elements up to the first aligned address and the
+//! elements after the last full vector with scalar code. The scalar kernels
+//! are used with compilers other than GCC and Clang, and on other
+//! architectures.
+//!
+//! Reductions combine the elements in a different order than a sequential
+//! loop. For floating-point values, the result may therefore differ by
+//! rounding. Integer sums, dot products and products wrap around on overflow,
+//! as if they were computed in the unsigned type of the same size. The minimum
+//! and maximum are unspecified when the values contain a NaN.
+namespace simd {
+
+//! \brief Return the instruction set that is used by the kernels.
+inline level active_level() noexcept {
+  return internal::simd_level().load(std::memory_order_relaxed);
+}
+
+//! \brief Return the widest instruction set supported by the processor.
+inline level supported_level() noexcept {
+  static level const l = internal::detect_simd_level();
+  return l;
+}
+
+//! \brief Use instruction set \p l, but no wider than supported_level(). This
+//! is meant for testing and benchmarking. Returns the instruction set that is
+//! used.
+inline level set_level(level l) noexcept {
+  l = std::min(l, supported_level());
+  internal::simd_level().store(l, std::memory_order_relaxed);
+  return l;
+}
+
+//! \brief Return the sum of the \p n elements at \p p.
+template <typename T_>
+T_ sum(T_ const* p, std::size_t n) noexcept {
+  static_assert(internal::is_simd_value_v<T_>, "unsupported value type");
+  return internal::simd_dispatch(internal::sum_kernel<T_>{p, n});
+}
+
+//! \brief Return the sum of the elements of \p r.
+template <typename Ring_>
+auto sum(Ring_ const& r) noexcept {
+  using value_type = typename Ring_::value_type;
+  internal::simd_scalar_t<value_type> s = 0;
+  for (auto const& seg : r.used_segments()) {
+    s += internal::simd_widen(sum(seg.data(), seg.size()));
+  }
+  return static_cast<value_type>(s);
+}
+
+//! \brief Return the smallest and the largest of the \p n elements at \p p.
+//! \details Undefined behavior if \p n is zero.
+template <typename T_>
+std::pair<T_, T_> minmax(T_ const* p, std::size_t n) noexcept {
+  static_assert(internal::is_simd_value_v<T_>, "unsupported value type");
+  assert(n > 0);
+  return internal::simd_dispatch(internal::minmax_kernel<T_>{p, n});
+}
+
+//! \brief Return the smallest and the largest element of \p r.
+//! \details Undefined behavior if \p r is empty.
+template <typename Ring_>
+auto minmax(Ring_ const& r) noexcept {
+  auto segments = r.used_segments();
+  auto m = minmax(segments[0].data(), segments[0].size());
+  if (!segments[1].empty()) {
+    auto m1 = minmax(segments[1].data(), segments[1].size());
+    m.first = m1.first < m.first ? m1.first : m.first;
+    m.second = m.second < m1.second ? m1.second : m.second;
+  }
+  return m;
+}
+
+//! \brief Return the smallest element of \p r.
+//! \details Undefined behavior if \p r is empty.
+template <typename Ring_>
+auto min(Ring_ const& r) noexcept {
+  return minmax(r).first;
+}
+
+//! \brief Return the largest element of \p r.
+//! \details Undefined behavior if \p r is empty.
+template <typename Ring_>
+auto max(Ring_ const& r) noexcept {
+  return minmax(r).second;
+}
+
+//! \brief Return the sum of the products of the \p n elements at \p a and
+//! \p b.
+template <typename T_>
+T_ dot(T_ const* a, T_ const* b, std::size_t n) noexcept {
+  static_assert(internal::is_simd_value_v<T_>, "unsupported value type");
+  return internal::simd_dispatch(internal::dot_kernel<T_>{a, b, n});
+}
+
+//! \brief Return the sum of the products of the elements of \p a and \p b.
+//! The segments of both rings may be split at different positions.
+//! \details Undefined behavior if the sizes of the rings differ.
+template <typename RingA_, typename RingB_>
+auto dot(RingA_ const& a, RingB_ const& b) noexcept {
+  assert(a.size() == b.size());
+  auto sa = a.used_segments();
+  auto sb = b.used_segments();
+  using value_type = typename RingA_::value_type;
+  internal::simd_scalar_t<value_type> s = 0;
+  std::size_t i = 0;
+  std::size_t j = 0;
+  std::size_t oa = 0;
+  std::size_t ob = 0;
+  while (i < 2 && j < 2) {
+    std::size_t m = std::min(sa[i].size() - oa, sb[j].size() - ob);
+    s += internal::simd_widen(dot(sa[i].data() + oa, sb[j].data() + ob, m));
+    oa += m;
+    ob += m;
+    if (oa == sa[i].size()) {
+      ++i;
+      oa = 0;
+    }
+    if (ob == sb[j].size()) {
+      ++j;
+      ob = 0;
+    }
+  }
+  return static_cast<value_type>(s);
+}
+
+//! \brief Return the number of the \p n elements at \p p that are equal to
+//! \p value.
+template <typename T_>
+std::size_t count_if_eq(T_ const* p, std::size_t n, T_ value) noexcept {
+  static_assert(internal::is_simd_value_v<T_>, "unsupported value type");
+  return internal::simd_dispatch(internal::count_kernel<T_>{p, n, value});
+}
+
+//! \brief Return the number of elements of \p r that are equal to \p value.
+template <typename Ring_>
+std::size_t count_if_eq(
+    Ring_ const& r, typename Ring_::value_type value) noexcept {
+  std::size_t c = 0;
+  for (auto const& seg : r.used_segments()) {
+    c += count_if_eq(seg.data(), seg.size(), value);
+  }
+  return c;
+}
+
+//! \brief Multiply each of the \p n elements at \p p by \p factor.
+template <typename T_>
+void scale(T_* p, std::size_t n, T_ factor) noexcept {
+  static_assert(internal::is_simd_value_v<T_>, "unsupported value type");
+  internal::simd_dispatch(internal::scale_kernel<T_>{p, n, factor});
+}
+
+//! \brief Multiply each element of \p r by \p factor.
+template <typename Ring_>
+void scale(Ring_& r, typename Ring_::value_type factor) noexcept {
+  for (auto const& seg : r.used_segments()) {
+    scale(seg.data(), seg.size(), factor);
+  }
+}
+
+}  // namespace simd
+
+}  // namespace ouroboros
+
+#if defined(OUROBOROS_SIMD_X86)
+#undef OUROBOROS_SIMD_INLINE
+#undef OUROBOROS_SIMD_X86
+#endif
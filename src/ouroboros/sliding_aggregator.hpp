@@ -0,0 +1,132 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "cyclic_deque.hpp"
+
+namespace ouroboros {
+
+//! \brief The aggregate of the last N values of a stream under an associative
+//! operation, such as a sum, a maximum, a greatest common divisor or a matrix
+//! product.
+//! \details Implements the Two-Stacks Lite algorithm of Tangwongsan, Hirzel
+//! and Schneider. The window is a single cyclic_deque that is split in two:
+//! * The front part holds, for each position, the aggregate of the values from
+//! that position to the end of the front part.
+//! * The back part holds the values themselves, and their aggregate is kept in
+//! a single variable.
+//!
+//! query() combines the first aggregate of the front part with the aggregate of
+//! the back part in O(1). Evicting a value pops the front of the ring. When the
+//! front part is empty, the back part is turned into a front part by computing
+//! the aggregates from back to front. Each value takes part in one such
+//! conversion, so push() and pop() are amortized O(1) and each value is
+//! combined at most twice.
+//!
+//! Op_ must be associative and have \p identity as its identity element. It
+//! doesn't need to be commutative or invertible: values are combined oldest
+//! first. Nothing is allocated after construction.
+template <
+    typename T_,
+    typename Op_ = std::plus<T_>,
+    typename Allocator_ = std::allocator<T_>>
+class sliding_aggregator {
+  using container = cyclic_deque<T_, Allocator_>;
+
+ public:
+  using allocator_type = Allocator_;
+  using size_type = std::size_t;
+  using value_type = T_;
+  using operation_type = Op_;
+
+  //! \brief Create a window of the last \p n values, aggregated with \p op.
+  explicit sliding_aggregator(
+      size_type n,
+      value_type identity = value_type(),
+      Op_ op = Op_(),
+      allocator_type const& a = allocator_type())
+      : ring_(n, a),
+        identity_(std::move(identity)),
+        op_(std::move(op)),
+        back_(identity_),
+        front_size_(0) {
+    assert(n > 0);
+  }
+
+  //! \brief Add \p value to the window, evicting the oldest value when the
+  //! window is full.
+  void push(value_type value) {
+    if (ring_.full()) {
+      pop();
+    }
+    back_ = op_(std::move(back_), value);
+    ring_.push_back(std::move(value));
+  }
+
+  //! \brief Remove the oldest value.
+  //! \details Undefined behavior if the window is empty.
+  void pop() {
+    assert(!empty());
+    if (front_size_ == 0) {
+      flip();
+    }
+    ring_.pop_front();
+    --front_size_;
+  }
+
+  //! \brief Remove all values.
+  void clear() {
+    ring_.clear();
+    back_ = identity_;
+    front_size_ = 0;
+  }
+
+  //! \brief Return the aggregate of the values in the window, oldest first, or
+  //! the identity when the window is empty.
+  value_type query() const {
+    if (front_size_ == 0) {
+      return back_;
+    }
+    return op_(ring_.front(), back_);
+  }
+
+  //! \brief Return the number of values in the window.
+  size_type size() const noexcept { return ring_.size(); }
+
+  //! \brief Return the maximum number of values in the window.
+  size_type capacity() const noexcept { return ring_.capacity(); }
+
+  //! \brief Return true if the window is empty.
+  bool empty() const noexcept { return ring_.empty(); }
+
+  //! \brief Return true if the window is full.
+  bool full() const noexcept { return ring_.full(); }
+
+  //! \brief Return the identity element.
+  value_type const& identity() const noexcept { return identity_; }
+
+ private:
+  //! \brief Turn the values of the back part into the aggregates of the front
+  //! part.
+  void flip() {
+    size_type n = ring_.size();
+    for (size_type i = n - 1; i > 0; --i) {
+      ring_[i - 1] = op_(std::move(ring_[i - 1]), ring_[i]);
+    }
+    front_size_ = n;
+    back_ = identity_;
+  }
+
+  container ring_;
+  value_type identity_;
+  Op_ op_;
+  // The aggregate of the back part.
+  value_type back_;
+  size_type front_size_;
+};
+
+}  // namespace ouroboros
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+#include "cyclic_deque.hpp"
+
+namespace ouroboros {
+
+//! \brief The minimum and maximum of the last N values of a stream.
+//! \details The values are kept in a cyclic_deque. When the window is full, a
+//! push() evicts the oldest value. Next to the values, two monotonic deques
+//! hold the positions of the candidates for the minimum and the maximum. A
+//! value stops being a candidate for the minimum as soon as a smaller value is
+//! pushed after it, because it will be evicted before that value. Each
+//! position is pushed and popped at most once, so push() is amortized O(1),
+//! and the minimum and maximum are always at the front of their deque.
+//!
+//! The positions are stored in two more cyclic_deque instances of the same
+//! capacity as the window, such that nothing is allocated after construction.
+template <
+    typename T_,
+    typename Compare_ = std::less<T_>,
+    typename Allocator_ = std::allocator<T_>>
+class sliding_min_max {
+  using container = cyclic_deque<T_, Allocator_>;
+  using index_container = cyclic_deque<
+      std::size_t,
+      typename std::allocator_traits<Allocator_>::template rebind_alloc<
+          std::size_t>>;
+
+ public:
+  using allocator_type = Allocator_;
+  using size_type = std::size_t;
+  using value_type = T_;
+  using value_compare = Compare_;
+  using const_reference = T_ const&;
+
+  //! \brief Create a window of the last \p n values, ordered by \p comp.
+  explicit sliding_min_max(
+      size_type n,
+      Compare_ const& comp = Compare_(),
+      allocator_type const& a = allocator_type())
+      : window_(n, a),
+        min_(n, typename index_container::allocator_type(a)),
+        max_(n, typename index_container::allocator_type(a)),
+        comp_(comp),
+        first_(0) {
+    assert(n > 0);
+  }
+
+  //! \brief Add \p value to the window, evicting the oldest value when the
+  //! window is full.
+  void push(value_type const& value) {
+    if (window_.full()) {
+      pop();
+    }
+    size_type pos = first_ + window_.size();
+    // Copy the value first, such that a throwing copy leaves the candidates
+    // as they were. The positions are pushed without allocating.
+    window_.push_back(value);
+    while (!min_.empty() && !comp_(at(min_.back()), value)) {
+      min_.pop_back();
+    }
+    while (!max_.empty() && !comp_(value, at(max_.back()))) {
+      max_.pop_back();
+    }
+    min_.push_back(pos);
+    max_.push_back(pos);
+  }
+
+  //! \brief Remove the oldest value.
+  //! \details Undefined behavior if the window is empty.
+  void pop() noexcept {
+    assert(!empty());
+    if (min_.front() == first_) {
+      min_.pop_front();
+    }
+    if (max_.front() == first_) {
+      max_.pop_front();
+    }
+    window_.pop_front();
+    ++first_;
+  }
+
+  //! \brief Remove all values.
+  void clear() noexcept {
+    first_ += window_.size();
+    window_.clear();
+    min_.clear();
+    max_.clear();
+  }
+
+  //! \brief Return the smallest value in the window. Of equal values, the
+  //! latest is returned.
+  //! \details Undefined behavior if the window is empty.
+  const_reference min() const noexcept {
+    assert(!empty());
+    return at(min_.front());
+  }
+
+  //! \brief Return the largest value in the window. Of equal values, the
+  //! latest is returned.
+  //! \details Undefined behavior if the window is empty.
+  const_reference max() const noexcept {
+    assert(!empty());
+    return at(max_.front());
+  }
+
+  //! \brief Return the values in the window, oldest first.
+  container const& window() const noexcept { return window_; }
+
+  //! \brief Return the number of values in the window.
+  size_type size() const noexcept { return window_.size(); }
+
+  //! \brief Return the maximum number of values in the window.
+  size_type capacity() const noexcept { return window_.capacity(); }
+
+  //! \brief Return true if the window is empty.
+  bool empty() const noexcept { return window_.empty(); }
+
+  //! \brief Return true if the window is full.
+  bool full() const noexcept { return window_.full(); }
+
+  //! \brief Return the comparison object.
+  value_compare value_comp() const { return comp_; }
+
+ private:
+  //! \brief Return the value at position \p pos, counted since construction.
+  const_reference at(size_type pos) const noexcept {
+    return window_[pos - first_];
+  }
+
+  container window_;
+  // The positions of the candidates for the minimum and the maximum. The
+  // values at these positions are strictly increasing and decreasing,
+  // respectively.
+  index_container min_;
+  index_container max_;
+  Compare_ comp_;
+  // The position of the oldest value in the window.
+  size_type first_;
+};
+
+}  // namespace ouroboros
@@ -0,0 +1,291 @@
+#pragma once
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "cyclic_deque.hpp"
+
+namespace ouroboros {
+
+//! \brief Quantiles, such as the median or the 99th percentile, of the last N
+//! values of a stream.
+//! \details The values are kept in a cyclic_deque. When the window is full, a
+//! push() evicts the oldest value. Next to the values, an order-statistics
+//! tree holds the same values in sorted order. The tree is a treap: a binary
+//! search tree in which each node has a random priority that is higher than
+//! the priorities of its children, which keeps the expected depth O(log N).
+//! Each node also stores the size of its subtree, such that the k-th smallest
+//! value is found by a single descent from the root. Equivalent values are
+//! kept in the order in which they were pushed, such that the oldest value of
+//! the window is always the first node among those equivalent to it.
+//!
+//! push(), pop() and each query are expected O(log N). The nodes are taken
+//! from a pool of N nodes that is allocated at construction, so nothing is
+//! allocated afterwards.
+template <
+    typename T_,
+    typename Compare_ = std::less<T_>,
+    typename Allocator_ = std::allocator<T_>>
+class sliding_quantile {
+  using index_type = std::uint32_t;
+
+  static constexpr index_type npos = std::numeric_limits<index_type>::max();
+
+  struct node {
+    T_ value;
+    std::uint32_t priority;
+    index_type left;
+    index_type right;
+    index_type size;
+  };
+
+  using container = cyclic_deque<T_, Allocator_>;
+  using node_container = std::vector<
+      node,
+      typename std::allocator_traits<Allocator_>::template rebind_alloc<node>>;
+
+ public:
+  using allocator_type = Allocator_;
+  using size_type = std::size_t;
+  using value_type = T_;
+  using value_compare = Compare_;
+  using const_reference = T_ const&;
+
+  //! \brief Create a window of the last \p n values, ordered by \p comp.
+  explicit sliding_quantile(
+      size_type n,
+      Compare_ const& comp = Compare_(),
+      allocator_type const& a = allocator_type())
+      : window_(n, a),
+        nodes_(n, typename node_container::allocator_type(a)),
+        comp_(comp),
+        root_(npos),
+        free_(npos),
+        seed_(0x9e3779b9u) {
+    assert(n > 0 && n < npos);
+    for (size_type i = n; i > 0; --i) {
+      release(static_cast<index_type>(i - 1));
+    }
+  }
+
+  //! \brief Add \p value to the window, evicting the oldest value when the
+  //! window is full.
+  void push(value_type const& value) {
+    if (window_.full()) {
+      pop();
+    }
+    // Fill the node before the window grows, such that a throwing copy leaves
+    // both as they were.
+    index_type i = allocate();
+    node& x = nodes_[i];
+    try {
+      x.value = value;
+      window_.push_back(value);
+    } catch (...) {
+      release(i);
+      throw;
+    }
+    x.priority = next_priority();
+    x.left = npos;
+    x.right = npos;
+    x.size = 1;
+    // The new node follows the equivalent values that are already there.
+    index_type l;
+    index_type r;
+    split(
+        root_, [this, &value](T_ const& v) { return !comp_(value, v); }, l, r);
+    root_ = merge(merge(l, i), r);
+  }
+
+  //! \brief Remove the oldest value.
+  //! \details Undefined behavior if the window is empty.
+  void pop() {
+    assert(!empty());
+    value_type const& value = window_.front();
+    index_type l;
+    index_type r;
+    split(root_, [this, &value](T_ const& v) { return comp_(v, value); }, l, r);
+    root_ = merge(l, erase_first(r));
+    window_.pop_front();
+  }
+
+  //! \brief Remove all values.
+  void clear() noexcept {
+    window_.clear();
+    root_ = npos;
+    free_ = npos;
+    for (size_type i = nodes_.size(); i > 0; --i) {
+      release(static_cast<index_type>(i - 1));
+    }
+  }
+
+  //! \brief Return the \p k-th smallest value, counting from zero.
+  //! \details Undefined behavior if \p k is not smaller than size().
+  const_reference select(size_type k) const noexcept {
+    assert(k < size());
+    index_type t = root_;
+    while (true) {
+      node const& x = nodes_[t];
+      size_type left = subtree_size(x.left);
+      if (k < left) {
+        t = x.left;
+      } else if (k == left) {
+        return x.value;
+      } else {
+        k -= left + 1;
+        t = x.right;
+      }
+    }
+  }
+
+  //! \brief Return the \p q quantile, with \p q within [0, 1], using the
+  //! nearest-rank method: the smallest value such that at least a fraction
+  //! \p q of the values is smaller than or equal to it.
+  //! \details Undefined behavior if the window is empty.
+  const_reference quantile(double q) const noexcept {
+    assert(!empty());
+    double rank = std::ceil(q * static_cast<double>(size()));
+    size_type k = rank > 1.0 ? static_cast<size_type>(rank) - 1 : 0;
+    return select(k < size() ? k : size() - 1);
+  }
+
+  //! \brief Return the median. For an even number of values, the lower of the
+  //! two middle values is returned.
+  //! \details Undefined behavior if the window is empty.
+  const_reference median() const noexcept { return select((size() - 1) / 2); }
+
+  //! \brief Return the number of values in the window that are smaller than
+  //! \p value.
+  size_type rank(value_type const& value) const noexcept {
+    size_type k = 0;
+    index_type t = root_;
+    while (t != npos) {
+      node const& x = nodes_[t];
+      if (comp_(x.value, value)) {
+        k += subtree_size(x.left) + 1;
+        t = x.right;
+      } else {
+        t = x.left;
+      }
+    }
+    return k;
+  }
+
+  //! \brief Return the values in the window, oldest first.
+  container const& window() const noexcept { return window_; }
+
+  //! \brief Return the number of values in the window.
+  size_type size() const noexcept { return window_.size(); }
+
+  //! \brief Return the maximum number of values in the window.
+  size_type capacity() const noexcept { return window_.capacity(); }
+
+  //! \brief Return true if the window is empty.
+  bool empty() const noexcept { return window_.empty(); }
+
+  //! \brief Return true if the window is full.
+  bool full() const noexcept { return window_.full(); }
+
+  //! \brief Return the comparison object.
+  value_compare value_comp() const { return comp_; }
+
+ private:
+  size_type subtree_size(index_type t) const noexcept {
+    return t == npos ? 0 : nodes_[t].size;
+  }
+
+  void update(index_type t) noexcept {
+    node& x = nodes_[t];
+    x.size = static_cast<index_type>(
+        subtree_size(x.left) + subtree_size(x.right) + 1);
+  }
+
+  //! \brief Split tree \p t into \p l, with the leading values for which
+  //! \p left is true, and \p r, with the others.
+  template <typename Pred_>
+  void split(index_type t, Pred_ const& left, index_type& l, index_type& r) {
+    if (t == npos) {
+      l = npos;
+      r = npos;
+      return;
+    }
+    node& x = nodes_[t];
+    if (left(x.value)) {
+      split(x.right, left, x.right, r);
+      l = t;
+    } else {
+      split(x.left, left, l, x.left);
+      r = t;
+    }
+    update(t);
+  }
+
+  //! \brief Merge the trees \p l and \p r, where all values of \p l are
+  //! ordered before those of \p r.
+  index_type merge(index_type l, index_type r) noexcept {
+    if (l == npos) {
+      return r;
+    }
+    if (r == npos) {
+      return l;
+    }
+    if (nodes_[l].priority > nodes_[r].priority) {
+      nodes_[l].right = merge(nodes_[l].right, r);
+      update(l);
+      return l;
+    }
+    nodes_[r].left = merge(l, nodes_[r].left);
+    update(r);
+    return r;
+  }
+
+  //! \brief Remove the first node of tree \p t and return the new root.
+  index_type erase_first(index_type t) noexcept {
+    assert(t != npos);
+    node& x = nodes_[t];
+    if (x.left == npos) {
+      index_type r = x.right;
+      release(t);
+      return r;
+    }
+    x.left = erase_first(x.left);
+    update(t);
+    return t;
+  }
+
+  index_type allocate() noexcept {
+    assert(free_ != npos);
+    index_type i = free_;
+    free_ = nodes_[i].left;
+    return i;
+  }
+
+  void release(index_type i) noexcept {
+    nodes_[i].left = free_;
+    free_ = i;
+  }
+
+  //! \brief Return the next value of a xorshift generator.
+  std::uint32_t next_priority() noexcept {
+    seed_ ^= seed_ << 13;
+    seed_ ^= seed_ >> 17;
+    seed_ ^= seed_ << 5;
+    return seed_;
+  }
+
+  container window_;
+  node_container nodes_;
+  Compare_ comp_;
+  index_type root_;
+  // The first node of the free list, which runs through the left links.
+  index_type free_;
+  std::uint32_t seed_;
+};
+
+}  // namespace ouroboros
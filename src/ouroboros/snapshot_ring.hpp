@@ -0,0 +1,181 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "concurrency.hpp"
+
+namespace ouroboros {
+
+//! \brief A single-writer ring that keeps the last capacity() elements and
+//! lets any number of readers copy a consistent snapshot of the latest N.
+//! \details The writer never blocks and never takes a lock: it overwrites the
+//! oldest element when the ring is full. The header, the number of elements
+//! written and the size, is guarded by a seqlock. Each slot has a version that
+//! is odd while the writer writes it and even once it is done. A reader first
+//! reads a consistent header and then copies the requested elements, oldest
+//! first, checking the version of each slot. When the writer overwrote one of
+//! them in the meantime, the reader retries with a newer header.
+//!
+//! The value_type must be trivially copyable because readers may copy an
+//! element while it is being overwritten, in which case the copy is discarded.
+//! The ring has one slot more than its capacity, which the writer fills before
+//! it publishes the element. That way a push doesn't overwrite any of the
+//! latest capacity() elements that a reader may be copying.
+template <typename T_, typename Allocator_ = std::allocator<T_>>
+class snapshot_ring {
+  static_assert(
+      std::is_trivially_copyable_v<T_>,
+      "ouroboros::snapshot_ring requires a trivially copyable value_type");
+
+  using slot = internal::seqlock_slot<T_>;
+  using slot_allocator =
+      typename std::allocator_traits<Allocator_>::template rebind_alloc<slot>;
+  using container = std::vector<slot, slot_allocator>;
+
+ public:
+  using allocator_type = Allocator_;
+  using size_type = std::size_t;
+  using value_type = T_;
+
+  //! \brief Create a ring that keeps the latest \p c elements in \p c + 1
+  //! slots.
+  explicit snapshot_ring(
+      size_type c, allocator_type const& a = allocator_type())
+      : slots_(c + 1, slot_allocator(a)),
+        capacity_(c),
+        sequence_(0),
+        written_(0),
+        size_(0) {}
+
+  snapshot_ring(snapshot_ring const&) = delete;
+
+  snapshot_ring& operator=(snapshot_ring const&) = delete;
+
+  //! \brief Write an element, overwriting the oldest one if the ring is full.
+  //! Writer only.
+  void push(value_type const& value) noexcept {
+    std::uint64_t pos = written_.load(std::memory_order_relaxed);
+    slots_[static_cast<size_type>(pos % slots_.size())].store(pos, value);
+
+    std::uint64_t seq = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    written_.store(pos + 1, std::memory_order_relaxed);
+    size_.store(
+        std::min<std::uint64_t>(pos + 1, capacity()),
+        std::memory_order_relaxed);
+    sequence_.store(seq + 2, std::memory_order_release);
+  }
+
+  //! \brief Copy the latest min(\p n, size()) elements into \p out, oldest
+  //! first. Returns the number of elements copied, or zero when the writer
+  //! interfered in each of the \p attempts.
+  size_type try_snapshot(
+      value_type* out, size_type n, size_type attempts = 1) const noexcept {
+    for (; attempts > 0; --attempts) {
+      std::uint64_t written;
+      size_type size;
+      read_header(written, size);
+      n = std::min(n, size);
+      if (copy(out, written - n, n)) {
+        return n;
+      }
+    }
+    return 0;
+  }
+
+  //! \brief Copy the latest min(\p n, size()) elements into \p out, oldest
+  //! first, retrying until the copy is consistent. Returns the number of
+  //! elements copied.
+  //! \details Retries become rare when \p n is smaller than capacity(), which
+  //! gives the reader time to copy the oldest element before the writer
+  //! overwrites it.
+  size_type snapshot(value_type* out, size_type n) const noexcept {
+    while (true) {
+      std::uint64_t written;
+      size_type size;
+      read_header(written, size);
+      size_type m = std::min(n, size);
+      if (copy(out, written - m, m)) {
+        return m;
+      }
+    }
+  }
+
+  //! \brief Return a consistent copy of the latest min(\p n, size()) elements,
+  //! oldest first.
+  std::vector<value_type> snapshot(size_type n) const {
+    std::vector<value_type> out(n);
+    out.resize(snapshot(out.data(), n));
+    return out;
+  }
+
+  //! \brief Copy the latest element into \p value. Returns false if the ring
+  //! is empty.
+  bool latest(value_type& value) const noexcept {
+    return snapshot(&value, 1) == 1;
+  }
+
+  //! \brief Return the maximum number of elements kept.
+  size_type capacity() const noexcept { return capacity_; }
+
+  //! \brief Return the number of elements kept, up to capacity().
+  size_type size() const noexcept {
+    std::uint64_t written;
+    size_type size;
+    read_header(written, size);
+    return size;
+  }
+
+  //! \brief Return the total number of elements written.
+  std::uint64_t written() const noexcept {
+    return written_.load(std::memory_order_acquire);
+  }
+
+ private:
+  //! \brief Read the header under the seqlock.
+  void read_header(std::uint64_t& written, size_type& size) const noexcept {
+    while (true) {
+      std::uint64_t s1 = sequence_.load(std::memory_order_acquire);
+      if ((s1 & 1) == 0) {
+        written = written_.load(std::memory_order_relaxed);
+        size = static_cast<size_type>(size_.load(std::memory_order_relaxed));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence_.load(std::memory_order_relaxed) == s1) {
+          return;
+        }
+      }
+      internal::cpu_relax();
+    }
+  }
+
+  //! \brief Copy the \p n elements starting at position \p first. Returns false
+  //! if any of them was overwritten during the copy.
+  bool copy(value_type* out, std::uint64_t first, size_type n) const noexcept {
+    size_type index = static_cast<size_type>(first % slots_.size());
+    for (size_type i = 0; i < n; ++i) {
+      if (!slots_[index].load(first + i, out[i])) {
+        return false;
+      }
+      if (++index == slots_.size()) {
+        index = 0;
+      }
+    }
+    return true;
+  }
+
+  // Shared and read-only after construction.
+  alignas(internal::cache_line_size) container slots_;
+  size_type capacity_;
+  // Written by the writer, guarded by the sequence.
+  alignas(internal::cache_line_size) std::atomic<std::uint64_t> sequence_;
+  std::atomic<std::uint64_t> written_;
+  std::atomic<std::uint64_t> size_;
+};
+
+}  // namespace ouroboros
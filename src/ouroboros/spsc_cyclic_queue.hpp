@@ -0,0 +1,210 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "concurrency.hpp"
+#include "contention_stats.hpp"
+#include "cyclic_deque.hpp"
+
+namespace ouroboros {
+
+//! \brief A lock-free, bounded, single-producer single-consumer FIFO queue.
+//! \details Exactly one thread may call the producer methods (try_push,
+//! try_push_n) and exactly one thread may call the consumer methods (try_pop,
+//! try_pop_n) concurrently. The head (consumer) and tail (producer) indices
+//! live on separate cache lines. Each side keeps a cached copy of the index of
+//! the other side and only reloads it when the queue appears to be full or
+//! empty, avoiding cross-core traffic on most operations.
+//!
+//! The Stats_ policy records full and empty queues. See contention_stats.
+template <
+    typename T_,
+    typename Allocator_ = std::allocator<T_>,
+    typename Stats_ = no_stats>
+class spsc_cyclic_queue {
+  static_assert(
+      std::is_same_v<std::remove_cv_t<T_>, T_>,
+      "ouroboros::spsc_cyclic_queue must have a non-const, non-volatile "
+      "value_type");
+
+  using container = std::vector<T_, Allocator_>;
+
+ public:
+  using allocator_type = typename container::allocator_type;
+  using stats_type = Stats_;
+  using size_type = typename container::size_type;
+  using value_type = typename container::value_type;
+  using reference = typename container::reference;
+  using const_reference = typename container::const_reference;
+
+  //! \brief Create a queue that can hold \p c elements.
+  //! \details One extra slot is allocated to distinguish a full queue from an
+  //! empty one.
+  explicit spsc_cyclic_queue(
+      size_type c, allocator_type const& a = allocator_type())
+      : buf_(c + 1, a),
+        head_(0),
+        cached_tail_(0),
+        tail_(0),
+        cached_head_(0) {}
+
+  spsc_cyclic_queue(spsc_cyclic_queue const&) = delete;
+
+  spsc_cyclic_queue& operator=(spsc_cyclic_queue const&) = delete;
+
+  //! \brief Add an element to the end of the queue. Returns false if the queue
+  //! is full. Producer only.
+  template <typename U_>
+  bool try_push(U_&& value) {
+    size_type tail = tail_.load(std::memory_order_relaxed);
+    size_type next = inc(tail);
+    if (next == cached_head_) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (next == cached_head_) {
+        stats_.full();
+        return false;
+      }
+    }
+    buf_[tail] = std::forward<U_>(value);
+    tail_.store(next, std::memory_order_release);
+    return true;
+  }
+
+  //! \brief Add up to \p n elements, read from \p first, to the end of the
+  //! queue and publish them at once. Returns the number of elements added.
+  //! Producer only.
+  template <typename InputIterator_>
+  size_type try_push_n(InputIterator_ first, size_type n) {
+    if (n == 0) {
+      return 0;
+    }
+    size_type tail = tail_.load(std::memory_order_relaxed);
+    size_type free = distance(tail, dec(cached_head_));
+    if (free < n) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      free = distance(tail, dec(cached_head_));
+    }
+    n = std::min(n, free);
+    if (n == 0) {
+      stats_.full();
+      return 0;
+    }
+
+    size_type size1 = std::min(n, slots() - tail);
+    first = copy_n(first, size1, buf_.begin() + tail);
+    copy_n(first, n - size1, buf_.begin());
+    tail_.store(
+        internal::wrap_cycle(tail + n, size_type(0), slots()),
+        std::memory_order_release);
+    return n;
+  }
+
+  //! \brief Remove the first element of the queue and move it into \p value.
+  //! Returns false if the queue is empty. Consumer only.
+  bool try_pop(value_type& value) {
+    size_type head = head_.load(std::memory_order_relaxed);
+    if (head == cached_tail_) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head == cached_tail_) {
+        stats_.empty();
+        return false;
+      }
+    }
+    value = std::move(buf_[head]);
+    head_.store(inc(head), std::memory_order_release);
+    return true;
+  }
+
+  //! \brief Remove up to \p n elements from the front of the queue and move
+  //! them to \p out. Returns the number of elements removed. Consumer only.
+  template <typename OutputIterator_>
+  size_type try_pop_n(OutputIterator_ out, size_type n) {
+    if (n == 0) {
+      return 0;
+    }
+    size_type head = head_.load(std::memory_order_relaxed);
+    size_type used = distance(head, cached_tail_);
+    if (used < n) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      used = distance(head, cached_tail_);
+    }
+    n = std::min(n, used);
+    if (n == 0) {
+      stats_.empty();
+      return 0;
+    }
+
+    size_type size1 = std::min(n, slots() - head);
+    auto first = buf_.begin() + head;
+    out = std::move(first, first + size1, out);
+    std::move(buf_.begin(), buf_.begin() + (n - size1), out);
+    head_.store(
+        internal::wrap_cycle(head + n, size_type(0), slots()),
+        std::memory_order_release);
+    return n;
+  }
+
+  //! \brief Return the maximum number of elements the queue can hold.
+  size_type capacity() const noexcept { return slots() - 1; }
+
+  //! \brief Return the number of elements in the queue. The value is only
+  //! exact when neither the producer nor the consumer is active.
+  size_type size() const noexcept {
+    return distance(
+        head_.load(std::memory_order_acquire),
+        tail_.load(std::memory_order_acquire));
+  }
+
+  //! \brief Return true if the queue is empty. The value is only exact when
+  //! neither the producer nor the consumer is active.
+  bool empty() const noexcept { return size() == 0; }
+
+  //! \brief Return the statistics policy.
+  stats_type& stats() noexcept { return stats_; }
+
+  //! \brief Return the statistics policy.
+  stats_type const& stats() const noexcept { return stats_; }
+
+ private:
+  size_type slots() const noexcept { return buf_.size(); }
+
+  size_type inc(size_type i) const noexcept {
+    return internal::inc_cycle(i, size_type(0), slots());
+  }
+
+  size_type dec(size_type i) const noexcept {
+    return internal::dec_cycle(i, size_type(0), slots());
+  }
+
+  //! \brief Return the number of steps it takes to go from \p first to \p last
+  //! in the cyclic range [0...slots()).
+  size_type distance(size_type first, size_type last) const noexcept {
+    return last >= first ? last - first : last + slots() - first;
+  }
+
+  template <typename InputIterator_, typename OutputIterator_>
+  static InputIterator_ copy_n(
+      InputIterator_ first, size_type n, OutputIterator_ out) {
+    for (; n > 0; --n, ++first, ++out) {
+      *out = *first;
+    }
+    return first;
+  }
+
+  // Shared and read-only after construction.
+  alignas(internal::cache_line_size) container buf_;
+  Stats_ stats_;
+  // Written by the consumer.
+  alignas(internal::cache_line_size) std::atomic<size_type> head_;
+  size_type cached_tail_;
+  // Written by the producer.
+  alignas(internal::cache_line_size) std::atomic<size_type> tail_;
+  size_type cached_head_;
+};
+
+}  // namespace ouroboros
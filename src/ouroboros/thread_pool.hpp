@@ -0,0 +1,392 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "mpmc_cyclic_queue.hpp"
+#include "ws_deque.hpp"
+
+namespace ouroboros {
+
+namespace internal {
+
+//! \brief A unit of work of the thread_pool.
+class task {
+ public:
+  virtual ~task() = default;
+
+  virtual void run() = 0;
+
+  //! \brief Called after run(). Returns true for a task that was submitted
+  //! and has now been deleted.
+  virtual bool finish() noexcept = 0;
+};
+
+//! \brief A task that is submitted to the pool and deletes itself once it has
+//! run.
+template <typename F_>
+class heap_task final : public task {
+ public:
+  explicit heap_task(F_ f) : f_(std::move(f)) {}
+
+  void run() override { f_(); }
+
+  bool finish() noexcept override {
+    delete this;
+    return true;
+  }
+
+ private:
+  F_ f_;
+};
+
+//! \brief A task that lives on the stack of a forking thread. The owner waits
+//! until it is done before it goes out of scope. An exception thrown by the
+//! task is kept for the owner.
+template <typename F_>
+class stack_task final : public task {
+ public:
+  explicit stack_task(F_ f) : f_(std::move(f)) {}
+
+  void run() override {
+    try {
+      f_();
+    } catch (...) {
+      error_ = std::current_exception();
+    }
+  }
+
+  bool finish() noexcept override {
+    // The task may be destroyed by its owner as soon as done is set.
+    done_.store(true, std::memory_order_release);
+    return false;
+  }
+
+  bool done() const noexcept { return done_.load(std::memory_order_acquire); }
+
+  //! \brief Rethrow the exception thrown by the task, if any. Undefined
+  //! behavior if the task didn't run yet.
+  void rethrow_if_failed() const {
+    if (error_) {
+      std::rethrow_exception(error_);
+    }
+  }
+
+ private:
+  F_ f_;
+  std::exception_ptr error_;
+  std::atomic<bool> done_{false};
+};
+
+}  // namespace internal
+
+//! \brief A work-stealing thread pool with one ws_deque per worker.
+//! \details Tasks spawned by a worker are pushed onto the deque of that
+//! worker, which runs them in LIFO order. Idle workers steal from the top of
+//! the deques of other workers. Tasks submitted by threads outside of the pool
+//! go through a shared mpmc_cyclic_queue. A thread that waits for a forked task
+//! runs other tasks in the meantime, which makes nested fork/join parallelism
+//! safe. Idle workers go to sleep after a short period of spinning.
+//!
+//! An exception thrown by a task passed to fork_join() or parallel_for() is
+//! rethrown by that call once all of its tasks are done. The first exception
+//! thrown by a task passed to submit() is rethrown by the next call to
+//! wait_idle(). Tasks never throw into a worker thread.
+class thread_pool {
+  using task = internal::task;
+
+ public:
+  using size_type = std::size_t;
+
+  //! \brief Create a pool with \p threads workers.
+  explicit thread_pool(
+      size_type threads = std::max(1u, std::thread::hardware_concurrency()))
+      : injected_(4096) {
+    threads = std::max<size_type>(threads, 1);
+    for (size_type i = 0; i < threads; ++i) {
+      workers_.push_back(std::make_unique<worker>());
+    }
+    for (size_type i = 0; i < threads; ++i) {
+      workers_[i]->thread = std::thread([this, i]() { worker_loop(i); });
+    }
+  }
+
+  thread_pool(thread_pool const&) = delete;
+
+  thread_pool& operator=(thread_pool const&) = delete;
+
+  //! \brief Wait for all submitted tasks and stop the workers. An exception
+  //! thrown by a submitted task that wasn't rethrown by wait_idle() is
+  //! discarded.
+  ~thread_pool() {
+    help_until([this]() {
+      return pending_.load(std::memory_order_acquire) == 0;
+    });
+    stop_.store(true, std::memory_order_seq_cst);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      cv_.notify_all();
+    }
+    for (auto& w : workers_) {
+      w->thread.join();
+    }
+  }
+
+  //! \brief Return the number of worker threads.
+  size_type size() const noexcept { return workers_.size(); }
+
+  //! \brief Run \p f asynchronously. Use wait_idle() to wait for completion.
+  template <typename F_>
+  void submit(F_&& f) {
+    auto* t = new internal::heap_task<std::decay_t<F_>>(std::forward<F_>(f));
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    spawn(t);
+  }
+
+  //! \brief Wait until all tasks passed to submit() have completed, running
+  //! tasks on the calling thread in the meantime. Rethrows the first exception
+  //! thrown by one of these tasks since the previous call.
+  void wait_idle() {
+    help_until([this]() {
+      return pending_.load(std::memory_order_acquire) == 0;
+    });
+    std::exception_ptr error;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      error = std::exchange(error_, nullptr);
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  //! \brief Run \p a and \p b in parallel and return when both are done. \p b
+  //! may be stolen by another worker while the calling thread runs \p a.
+  //! \details When \p a or \p b throws, the exception is rethrown after both
+  //! are done. When both throw, the exception of \p a is rethrown.
+  template <typename A_, typename B_>
+  void fork_join(A_&& a, B_&& b) {
+    auto run_b = [&b]() { b(); };
+    internal::stack_task<decltype(run_b)> tb(run_b);
+    spawn(&tb);
+    // tb must not go out of scope while it is queued or running, also when
+    // a() throws.
+    std::exception_ptr error;
+    try {
+      a();
+    } catch (...) {
+      error = std::current_exception();
+    }
+    join(tb);
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    tb.rethrow_if_failed();
+  }
+
+  //! \brief Call \p f(i) for each i in [first...last) in parallel. The range
+  //! is split recursively until a part contains at most \p grain indices.
+  template <typename Index_, typename F_>
+  void parallel_for(Index_ first, Index_ last, Index_ grain, F_&& f) {
+    grain = std::max<Index_>(grain, 1);
+    parallel_for_impl(first, last, grain, f);
+  }
+
+ private:
+  struct worker {
+    ws_deque<task*> deque;
+    std::thread thread;
+    std::uint64_t rng = 0x9e3779b97f4a7c15;
+  };
+
+  struct current {
+    thread_pool const* pool;
+    size_type index;
+  };
+
+  static current& current_context() noexcept {
+    static thread_local current c{nullptr, 0};
+    return c;
+  }
+
+  //! \brief Return the worker of the calling thread when it belongs to this
+  //! pool, or nullptr otherwise.
+  worker* current_worker() const noexcept {
+    current& c = current_context();
+    return c.pool == this ? workers_[c.index].get() : nullptr;
+  }
+
+  template <typename Index_, typename F_>
+  void parallel_for_impl(Index_ first, Index_ last, Index_ grain, F_& f) {
+    if (last - first <= grain) {
+      for (Index_ i = first; i < last; ++i) {
+        f(i);
+      }
+    } else {
+      Index_ middle = first + (last - first) / 2;
+      fork_join(
+          [&]() { parallel_for_impl(first, middle, grain, f); },
+          [&]() { parallel_for_impl(middle, last, grain, f); });
+    }
+  }
+
+  //! \brief Wait until \p t, which was spawned by the calling thread, is done.
+  template <typename Task_>
+  void join(Task_& t) {
+    worker* self = current_worker();
+    if (self != nullptr) {
+      // If nobody stole t, it is still on top of our own deque.
+      task* top;
+      if (self->deque.pop(top)) {
+        if (top == &t) {
+          t.run();
+          return;
+        }
+        execute(top);
+      }
+    }
+    help_until([&t]() { return t.done(); });
+  }
+
+  void spawn(task* t) {
+    worker* self = current_worker();
+    if (self != nullptr) {
+      self->deque.push(t);
+    } else if (!injected_.try_push(t)) {
+      // The injection queue is full. Run the task on the calling thread.
+      execute(t);
+      return;
+    }
+    notify();
+  }
+
+  void notify() {
+    // Pairs with the fence in sleep(). Either the sleeper sees the new task
+    // or we see the sleeper.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      cv_.notify_one();
+    }
+  }
+
+  void execute(task* t) {
+    try {
+      t->run();
+    } catch (...) {
+      // Only a submitted task can throw. A stack_task keeps its exception.
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!error_) {
+        error_ = std::current_exception();
+      }
+    }
+    if (t->finish()) {
+      pending_.fetch_sub(1, std::memory_order_release);
+    }
+  }
+
+  //! \brief Find a task to run: from our own deque, the injection queue or by
+  //! stealing from a random other worker.
+  task* find_task(worker* self) {
+    task* t;
+    if (self != nullptr && self->deque.pop(t)) {
+      return t;
+    }
+    if (injected_.try_pop(t)) {
+      return t;
+    }
+    size_type n = workers_.size();
+    size_type start = 0;
+    if (self != nullptr) {
+      // xorshift64
+      self->rng ^= self->rng << 13;
+      self->rng ^= self->rng >> 7;
+      self->rng ^= self->rng << 17;
+      start = static_cast<size_type>(self->rng % n);
+    }
+    for (size_type i = 0; i < n; ++i) {
+      worker* victim = workers_[(start + i) % n].get();
+      if (victim != self && victim->deque.steal(t)) {
+        return t;
+      }
+    }
+    return nullptr;
+  }
+
+  bool has_work() const noexcept {
+    if (!injected_.empty()) {
+      return true;
+    }
+    for (auto const& w : workers_) {
+      if (!w->deque.empty()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  template <typename Predicate_>
+  void help_until(Predicate_ done) {
+    worker* self = current_worker();
+    while (!done()) {
+      if (task* t = find_task(self)) {
+        execute(t);
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  void sleep() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    sleepers_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!has_work() && !stop_.load(std::memory_order_relaxed)) {
+      // The timeout is a safety net. Wakeups are normally signalled by
+      // notify().
+      cv_.wait_for(lock, std::chrono::milliseconds(10));
+    }
+    sleepers_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  void worker_loop(size_type index) {
+    current_context() = {this, index};
+    worker* self = workers_[index].get();
+    constexpr int spins_before_sleep = 64;
+    int idle = 0;
+    while (!stop_.load(std::memory_order_acquire)) {
+      if (task* t = find_task(self)) {
+        execute(t);
+        idle = 0;
+      } else if (++idle < spins_before_sleep) {
+        std::this_thread::yield();
+      } else {
+        sleep();
+        idle = 0;
+      }
+    }
+  }
+
+  std::vector<std::unique_ptr<worker>> workers_;
+  mpmc_cyclic_queue<task*> injected_;
+  alignas(internal::cache_line_size) std::atomic<size_type> pending_{0};
+  alignas(internal::cache_line_size) std::atomic<size_type> sleepers_{0};
+  std::atomic<bool> stop_{false};
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  //! \brief The first exception thrown by a submitted task. Guarded by mutex_.
+  std::exception_ptr error_;
+};
+
+}  // namespace ouroboros
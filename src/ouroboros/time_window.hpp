@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "cyclic_deque.hpp"
+
+namespace ouroboros {
+
+//! \brief The values of a stream that were pushed within the last span() of
+//! time, such as the last 5 seconds.
+//! \details Values are pushed with a timestamp, in order of time, into a
+//! cyclic_deque that doubles its capacity when it is full. Values are only
+//! evicted by advance(), which finds the first value to keep with a binary
+//! search in each of the (at most two) sorted segments of the ring, and then
+//! removes all older values with a single pop_front(n).
+//!
+//! The count-based sliding windows, such as windowed_stats, sliding_min_max,
+//! sliding_aggregator and sliding_quantile, follow a time_window by pushing
+//! the same values and popping one value for each value that advance()
+//! evicts:
+//! \code{.cpp}
+//! window.push(now, v);
+//! stats.push(v);
+//! window.advance(now, [&stats](auto const&) { stats.pop(); });
+//! \endcode
+//! The capacity of a count-based window must then be at least the largest
+//! number of values within a span.
+template <
+    typename T_,
+    typename Clock_ = std::chrono::steady_clock,
+    typename Allocator_ = std::allocator<T_>>
+class time_window {
+ public:
+  using clock = Clock_;
+  using time_point = typename Clock_::time_point;
+  using duration = typename Clock_::duration;
+  using size_type = std::size_t;
+  using value_type = T_;
+
+  //! \brief A value and the time at which it was pushed.
+  struct entry {
+    time_point time;
+    T_ value;
+  };
+
+ private:
+  using container = cyclic_deque<
+      entry,
+      typename std::allocator_traits<Allocator_>::template rebind_alloc<
+          entry>>;
+
+ public:
+  using allocator_type = Allocator_;
+
+  //! \brief Create a window that keeps the values of the last \p span, with an
+  //! initial capacity of \p c values.
+  explicit time_window(
+      duration span,
+      size_type c = 16,
+      allocator_type const& a = allocator_type())
+      : ring_(
+            std::max<size_type>(c, 1),
+            typename container::allocator_type(a)),
+        allocator_(a),
+        span_(span) {}
+
+  //! \brief Add \p value with timestamp \p time. Doubles the capacity when the
+  //! window is full.
+  //! \details Undefined behavior if \p time is before the timestamp of the
+  //! latest value.
+  void push(time_point time, value_type value) {
+    assert(ring_.empty() || !(time < ring_.back().time));
+    if (ring_.full()) {
+      grow();
+    }
+    ring_.push_back(entry{time, std::move(value)});
+  }
+
+  //! \brief Evict all values with a timestamp at or before \p now - span().
+  //! Returns the number of evicted values.
+  size_type advance(time_point now) noexcept {
+    size_type n = expired(now - span_);
+    ring_.pop_front(n);
+    return n;
+  }
+
+  //! \brief Evict all values with a timestamp at or before \p now - span(),
+  //! and call \p f(value) for each of them, oldest first, before they are
+  //! removed. Returns the number of evicted values.
+  template <typename F_>
+  size_type advance(time_point now, F_&& f) {
+    size_type n = expired(now - span_);
+    size_type remaining = n;
+    for (auto const& s : ring_.used_segments()) {
+      size_type m = std::min(remaining, s.size());
+      for (size_type i = 0; i < m; ++i) {
+        f(s[i].value);
+      }
+      remaining -= m;
+    }
+    ring_.pop_front(n);
+    return n;
+  }
+
+  //! \brief Remove all values.
+  void clear() noexcept { ring_.clear(); }
+
+  //! \brief Return the oldest entry.
+  //! \details Undefined behavior if the window is empty.
+  entry const& front() const noexcept { return ring_.front(); }
+
+  //! \brief Return the latest entry.
+  //! \details Undefined behavior if the window is empty.
+  entry const& back() const noexcept { return ring_.back(); }
+
+  //! \brief Return the entries in the window, oldest first.
+  container const& window() const noexcept { return ring_; }
+
+  //! \brief Return the length of time for which values are kept.
+  duration span() const noexcept { return span_; }
+
+  //! \brief Return the number of values in the window.
+  size_type size() const noexcept { return ring_.size(); }
+
+  //! \brief Return the number of values the window can hold before it grows.
+  size_type capacity() const noexcept { return ring_.capacity(); }
+
+  //! \brief Return true if the window is empty.
+  bool empty() const noexcept { return ring_.empty(); }
+
+ private:
+  //! \brief Return the number of values with a timestamp at or before
+  //! \p cutoff. The segments are searched separately because each of them is
+  //! sorted, and all values of the first precede those of the second.
+  size_type expired(time_point cutoff) const noexcept {
+    auto after = [](time_point t, entry const& e) { return t < e.time; };
+    auto segments = ring_.used_segments();
+    auto const& s0 = segments[0];
+    if (!s0.empty() && cutoff < s0[s0.size() - 1].time) {
+      return static_cast<size_type>(
+          std::upper_bound(s0.begin(), s0.end(), cutoff, after) - s0.begin());
+    }
+    auto const& s1 = segments[1];
+    return s0.size() +
+           static_cast<size_type>(
+               std::upper_bound(s1.begin(), s1.end(), cutoff, after) -
+               s1.begin());
+  }
+
+  void grow() {
+    container grown(
+        ring_.capacity() * 2, typename container::allocator_type(allocator_));
+    for (auto& e : ring_) {
+      grown.push_back(std::move(e));
+    }
+    ring_ = std::move(grown);
+  }
+
+  container ring_;
+  allocator_type allocator_;
+  duration span_;
+};
+
+}  // namespace ouroboros
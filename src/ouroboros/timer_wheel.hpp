@@ -0,0 +1,269 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace ouroboros {
+
+//! \brief A hierarchical hashed timing wheel.
+//! \details The wheel has several levels, each of which is a cyclic array of
+//! buckets. A bucket at level k holds the timers that expire within a range of
+//! 2^(k * bits) ticks. When the time advances past the end of such a range,
+//! the timers of the next bucket of level k are cascaded into lower levels,
+//! until they end up in level 0, which has a bucket per tick. Each level is a
+//! single contiguous allocation of bucket heads. The wheel counts the timers
+//! per level, which lets advance() skip the ticks at which nothing can expire
+//! or cascade.
+//!
+//! Timers are kept in doubly linked lists that run through a pool of nodes,
+//! which makes schedule() and cancel() O(1). The nodes are recycled through a
+//! free list. A handle remains safe to use after its timer expired or was
+//! cancelled because nodes carry a generation count.
+template <typename T_>
+class timer_wheel {
+  using index_type = std::uint32_t;
+
+  static constexpr index_type npos = std::numeric_limits<index_type>::max();
+
+  struct node {
+    std::optional<T_> value;
+    std::uint64_t expiry = 0;
+    index_type prev = npos;
+    index_type next = npos;
+    std::uint32_t generation = 0;
+    //! \brief The level and slot of the bucket, or npos when the node is free.
+    index_type level = npos;
+    index_type slot = 0;
+  };
+
+ public:
+  using tick_type = std::uint64_t;
+  using size_type = std::size_t;
+  using value_type = T_;
+
+  //! \brief Identifies a scheduled timer.
+  class handle {
+   public:
+    //! \brief Create a handle that doesn't refer to a timer.
+    constexpr handle() noexcept : index_(npos), generation_(0) {}
+
+    friend constexpr bool operator==(handle a, handle b) noexcept {
+      return a.index_ == b.index_ && a.generation_ == b.generation_;
+    }
+
+    friend constexpr bool operator!=(handle a, handle b) noexcept {
+      return !(a == b);
+    }
+
+   private:
+    friend class timer_wheel;
+
+    constexpr handle(index_type index, std::uint32_t generation) noexcept
+        : index_(index), generation_(generation) {}
+
+    index_type index_;
+    std::uint32_t generation_;
+  };
+
+  //! \brief Create a wheel that starts at tick \p now, with \p levels levels
+  //! of 2^\p bits buckets each. The default covers 2^32 ticks without
+  //! rescheduling timers at the top level.
+  explicit timer_wheel(tick_type now = 0, size_type levels = 4, int bits = 8)
+      : now_(now),
+        bits_(bits),
+        mask_((tick_type(1) << bits) - 1),
+        levels_(levels, std::vector<index_type>(size_type(1) << bits, npos)),
+        counts_(levels, 0),
+        free_(npos),
+        size_(0) {
+    assert(levels > 0 && bits > 0 && bits * levels <= 64);
+  }
+
+  //! \brief Schedule a timer that expires at tick \p expiry and return its
+  //! handle. A timer that expires at or before now() expires at the next tick.
+  template <typename U_>
+  handle schedule(tick_type expiry, U_&& value) {
+    index_type i = allocate();
+    node& n = nodes_[i];
+    n.value.emplace(std::forward<U_>(value));
+    n.expiry = expiry > now_ ? expiry : now_ + 1;
+    link(i);
+    ++size_;
+    return handle(i, n.generation);
+  }
+
+  //! \brief Cancel the timer of \p h. Returns false if it already expired or
+  //! was cancelled.
+  bool cancel(handle h) {
+    if (!active(h)) {
+      return false;
+    }
+    unlink(h.index_);
+    release(h.index_);
+    return true;
+  }
+
+  //! \brief Return true if the timer of \p h is still scheduled.
+  bool active(handle h) const noexcept {
+    return h.index_ < nodes_.size() &&
+           nodes_[h.index_].generation == h.generation_ &&
+           nodes_[h.index_].level != npos;
+  }
+
+  //! \brief Advance the time to \p now and call \p f(value) for each timer
+  //! that expired, in order of expiry. Timers that expire at the same tick are
+  //! passed in no particular order. Returns the number of expired timers.
+  //! \details \p f may schedule and cancel timers. The time never goes back.
+  template <typename F_>
+  size_type advance(tick_type now, F_&& f) {
+    size_type expired = 0;
+    while (now_ < now) {
+      if (size_ == 0) {
+        now_ = now;
+        break;
+      }
+      // When the lowest levels are empty, nothing happens before the next
+      // tick at which a bucket of the lowest non-empty level cascades.
+      size_type k = 0;
+      while (counts_[k] == 0) {
+        ++k;
+      }
+      if (k > 0) {
+        tick_type last = now_ | ((tick_type(1) << (bits_ * k)) - 1);
+        if (last >= now) {
+          now_ = now;
+          break;
+        }
+        now_ = last;
+      }
+      ++now_;
+      cascade();
+      std::vector<index_type>& level0 = levels_[0];
+      index_type& head = level0[now_ & mask_];
+      while (head != npos) {
+        index_type i = head;
+        unlink(i);
+        T_ value = std::move(*nodes_[i].value);
+        release(i);
+        ++expired;
+        f(std::move(value));
+      }
+    }
+    return expired;
+  }
+
+  //! \brief Return the current tick.
+  tick_type now() const noexcept { return now_; }
+
+  //! \brief Return the number of scheduled timers.
+  size_type size() const noexcept { return size_; }
+
+  //! \brief Return true if no timers are scheduled.
+  bool empty() const noexcept { return size_ == 0; }
+
+ private:
+  //! \brief Move the timers of the buckets that start at the current tick to
+  //! lower levels, starting at the highest level.
+  void cascade() {
+    size_type top = 0;
+    while (top + 1 < levels_.size() &&
+           (now_ & ((tick_type(1) << (bits_ * (top + 1))) - 1)) == 0) {
+      ++top;
+    }
+    for (size_type k = top; k > 0; --k) {
+      index_type& head =
+          levels_[k][static_cast<size_type>((now_ >> (bits_ * k)) & mask_)];
+      // Detach the list first. Timers beyond the range of the top level may
+      // be linked into the same bucket again.
+      index_type i = head;
+      head = npos;
+      while (i != npos) {
+        index_type next = nodes_[i].next;
+        --counts_[k];
+        link(i);
+        i = next;
+      }
+    }
+  }
+
+  //! \brief Link node \p i into the bucket for its expiry, relative to the
+  //! current tick.
+  void link(index_type i) {
+    node& n = nodes_[i];
+    tick_type expiry = n.expiry;
+    // The lowest level at which the expiry and the current tick share all
+    // higher digits.
+    size_type k = 0;
+    size_type last = levels_.size() - 1;
+    while (k < last && shift(expiry, k + 1) != shift(now_, k + 1)) {
+      ++k;
+    }
+    index_type slot = static_cast<index_type>(shift(expiry, k) & mask_);
+    index_type& head = levels_[k][slot];
+    n.level = static_cast<index_type>(k);
+    n.slot = slot;
+    ++counts_[k];
+    n.prev = npos;
+    n.next = head;
+    if (head != npos) {
+      nodes_[head].prev = i;
+    }
+    head = i;
+  }
+
+  void unlink(index_type i) noexcept {
+    node& n = nodes_[i];
+    --counts_[n.level];
+    if (n.prev != npos) {
+      nodes_[n.prev].next = n.next;
+    } else {
+      levels_[n.level][n.slot] = n.next;
+    }
+    if (n.next != npos) {
+      nodes_[n.next].prev = n.prev;
+    }
+  }
+
+  tick_type shift(tick_type t, size_type k) const noexcept {
+    size_type s = static_cast<size_type>(bits_) * k;
+    return s < 64 ? t >> s : 0;
+  }
+
+  index_type allocate() {
+    if (free_ != npos) {
+      index_type i = free_;
+      free_ = nodes_[i].next;
+      return i;
+    }
+    assert(nodes_.size() < npos);
+    nodes_.emplace_back();
+    return static_cast<index_type>(nodes_.size() - 1);
+  }
+
+  void release(index_type i) noexcept {
+    node& n = nodes_[i];
+    n.value.reset();
+    n.level = npos;
+    ++n.generation;
+    n.next = free_;
+    free_ = i;
+    --size_;
+  }
+
+  tick_type now_;
+  int bits_;
+  tick_type mask_;
+  std::vector<std::vector<index_type>> levels_;
+  //! \brief The number of timers per level.
+  std::vector<size_type> counts_;
+  std::vector<node> nodes_;
+  index_type free_;
+  size_type size_;
+};
+
+}  // namespace ouroboros
@@ -0,0 +1,331 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <thread>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <ctime>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+#include "concurrency.hpp"
+#include "contention_stats.hpp"
+
+namespace ouroboros {
+
+//! \brief Wait strategies decide how a thread waits for a condition that is
+//! made true by another thread, such as a queue becoming non-empty.
+//! \details Every wait strategy has the following interface:
+//! * wait(ready): Return once \p ready() returns true.
+//! * wait_until(ready, deadline): Return true once \p ready() returns true, or
+//! false when \p deadline passed first.
+//! * notify(): Wake a waiter after the condition may have become true for
+//! one of them, such as after pushing one element.
+//! * notify_all(): Wake all waiters, such as when a queue is closed.
+//!
+//! Each method also has an overload that takes a statistics policy as its last
+//! argument, to which it reports when threads park and unpark. See
+//! contention_stats.
+//!
+//! The predicate is evaluated by the waiting thread and is allowed to have
+//! side effects, such as popping an element. A waiter returns as soon as it
+//! succeeds.
+
+//! \brief Busy-spin with a cpu_relax() hint. Gives the lowest wakeup latency
+//! at the cost of a fully occupied core. notify() is free.
+class spin_wait {
+ public:
+  using clock = std::chrono::steady_clock;
+
+  template <typename Predicate_>
+  void wait(Predicate_&& ready) {
+    while (!ready()) {
+      internal::cpu_relax();
+    }
+  }
+
+  template <typename Predicate_>
+  bool wait_until(Predicate_&& ready, clock::time_point deadline) {
+    while (!ready()) {
+      if (clock::now() >= deadline) {
+        return false;
+      }
+      internal::cpu_relax();
+    }
+    return true;
+  }
+
+  template <typename Predicate_, typename Stats_>
+  void wait(Predicate_&& ready, Stats_&) {
+    wait(ready);
+  }
+
+  template <typename Predicate_, typename Stats_>
+  bool wait_until(
+      Predicate_&& ready, clock::time_point deadline, Stats_&) {
+    return wait_until(ready, deadline);
+  }
+
+  void notify() noexcept {}
+
+  template <typename Stats_>
+  void notify(Stats_&) noexcept {}
+
+  void notify_all() noexcept {}
+
+  template <typename Stats_>
+  void notify_all(Stats_&) noexcept {}
+};
+
+//! \brief Busy-spin for a short while, then yield the processor between
+//! checks. notify() is free.
+class yield_wait {
+ public:
+  using clock = std::chrono::steady_clock;
+
+  //! \brief The number of checks before the waiter starts yielding.
+  static constexpr int spin_count = 128;
+
+  template <typename Predicate_>
+  void wait(Predicate_&& ready) {
+    for (int i = 0; !ready(); ++i) {
+      relax(i);
+    }
+  }
+
+  template <typename Predicate_>
+  bool wait_until(Predicate_&& ready, clock::time_point deadline) {
+    for (int i = 0; !ready(); ++i) {
+      if (clock::now() >= deadline) {
+        return false;
+      }
+      relax(i);
+    }
+    return true;
+  }
+
+  template <typename Predicate_, typename Stats_>
+  void wait(Predicate_&& ready, Stats_&) {
+    wait(ready);
+  }
+
+  template <typename Predicate_, typename Stats_>
+  bool wait_until(
+      Predicate_&& ready, clock::time_point deadline, Stats_&) {
+    return wait_until(ready, deadline);
+  }
+
+  void notify() noexcept {}
+
+  template <typename Stats_>
+  void notify(Stats_&) noexcept {}
+
+  void notify_all() noexcept {}
+
+  template <typename Stats_>
+  void notify_all(Stats_&) noexcept {}
+
+ private:
+  static void relax(int i) noexcept {
+    if (i < spin_count) {
+      internal::cpu_relax();
+    } else {
+      std::this_thread::yield();
+    }
+  }
+};
+
+//! \brief Busy-spin for a short while, then park the thread in the kernel.
+//! Uses a futex on Linux and a condition variable elsewhere.
+//! \details The strategy is an event count: a waiter registers itself and
+//! reads the epoch before it checks the condition one last time, and only
+//! parks when the epoch is unchanged. notify() only enters the kernel when a
+//! waiter is registered, which makes it a single load when nobody waits. It
+//! then wakes a single waiter, since waiters check their condition again
+//! after waking up and any other waiter would go straight back to sleep.
+class futex_wait {
+ public:
+  using clock = std::chrono::steady_clock;
+
+  //! \brief The number of checks before the waiter parks.
+  static constexpr int spin_count = 128;
+
+  futex_wait() noexcept : epoch_(0), waiters_(0) {}
+
+  futex_wait(futex_wait const&) = delete;
+
+  futex_wait& operator=(futex_wait const&) = delete;
+
+  template <typename Predicate_>
+  void wait(Predicate_&& ready) {
+    no_stats stats;
+    wait_impl(ready, nullptr, stats);
+  }
+
+  template <typename Predicate_, typename Stats_>
+  void wait(Predicate_&& ready, Stats_& stats) {
+    wait_impl(ready, nullptr, stats);
+  }
+
+  template <typename Predicate_>
+  bool wait_until(Predicate_&& ready, clock::time_point deadline) {
+    no_stats stats;
+    return wait_impl(ready, &deadline, stats);
+  }
+
+  template <typename Predicate_, typename Stats_>
+  bool wait_until(
+      Predicate_&& ready, clock::time_point deadline, Stats_& stats) {
+    return wait_impl(ready, &deadline, stats);
+  }
+
+  void notify() noexcept {
+    no_stats stats;
+    notify(stats);
+  }
+
+  template <typename Stats_>
+  void notify(Stats_& stats) noexcept(noexcept(stats.unpark())) {
+    if (advance_epoch()) {
+      stats.unpark();
+      wake(1);
+    }
+  }
+
+  void notify_all() noexcept {
+    no_stats stats;
+    notify_all(stats);
+  }
+
+  template <typename Stats_>
+  void notify_all(Stats_& stats) noexcept(noexcept(stats.unpark())) {
+    if (advance_epoch()) {
+      stats.unpark();
+      wake(INT_MAX);
+    }
+  }
+
+ private:
+  //! \brief Change the epoch when a waiter is registered. Returns true if it
+  //! did.
+  bool advance_epoch() noexcept {
+    // Pairs with the fence in wait_impl(). Either the waiter sees the change
+    // that made its condition true, or we see the waiter.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters_.load(std::memory_order_relaxed) == 0) {
+      return false;
+    }
+    epoch_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  template <typename Predicate_, typename Stats_>
+  bool wait_impl(
+      Predicate_& ready, clock::time_point const* deadline, Stats_& stats) {
+    for (int i = 0; i < spin_count; ++i) {
+      if (ready()) {
+        return true;
+      }
+      internal::cpu_relax();
+    }
+
+    while (true) {
+      waiters_.fetch_add(1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      std::uint32_t epoch = epoch_.load(std::memory_order_relaxed);
+      if (ready()) {
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+      }
+      stats.park();
+      bool timed_out = park(epoch, deadline);
+      waiters_.fetch_sub(1, std::memory_order_relaxed);
+      if (ready()) {
+        return true;
+      }
+      if (timed_out) {
+        return false;
+      }
+    }
+  }
+
+#if defined(__linux__)
+  static_assert(
+      sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t) &&
+          std::atomic<std::uint32_t>::is_always_lock_free,
+      "ouroboros::futex_wait requires a lock free 32-bit atomic");
+
+  //! \brief Sleep while the epoch equals \p epoch. Returns true when
+  //! \p deadline has passed.
+  bool park(std::uint32_t epoch, clock::time_point const* deadline) noexcept {
+    timespec ts;
+    timespec* timeout = nullptr;
+    if (deadline != nullptr) {
+      auto now = clock::now();
+      if (now >= *deadline) {
+        return true;
+      }
+      auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    *deadline - now)
+                    .count();
+      ts.tv_sec = static_cast<std::time_t>(ns / 1000000000);
+      ts.tv_nsec = static_cast<long>(ns % 1000000000);
+      timeout = &ts;
+    }
+    // Returns immediately when the epoch changed in the meantime. Spurious
+    // wakeups are handled by the caller.
+    syscall(
+        SYS_futex, reinterpret_cast<std::uint32_t*>(&epoch_),
+        FUTEX_WAIT_PRIVATE, epoch, timeout, nullptr, 0);
+    return deadline != nullptr && clock::now() >= *deadline;
+  }
+
+  //! \brief Wake up to \p n parked waiters.
+  void wake(int n) noexcept {
+    syscall(
+        SYS_futex, reinterpret_cast<std::uint32_t*>(&epoch_),
+        FUTEX_WAKE_PRIVATE, n, nullptr, nullptr, 0);
+  }
+#else
+  bool park(std::uint32_t epoch, clock::time_point const* deadline) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto changed = [this, epoch]() {
+      return epoch_.load(std::memory_order_relaxed) != epoch;
+    };
+    if (deadline == nullptr) {
+      cv_.wait(lock, changed);
+      return false;
+    }
+    return !cv_.wait_until(lock, *deadline, changed);
+  }
+
+  //! \brief Wake one parked waiter, or all of them when \p n is larger than
+  //! one.
+  void wake(int n) {
+    // Taking the lock orders the wakeup after a waiter that checked the epoch.
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (n == 1) {
+      cv_.notify_one();
+    } else {
+      cv_.notify_all();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+#endif
+
+  alignas(internal::cache_line_size) std::atomic<std::uint32_t> epoch_;
+  std::atomic<std::uint32_t> waiters_;
+};
+
+}  // namespace ouroboros
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+#include "cyclic_deque.hpp"
+
+namespace ouroboros {
+
+//! \brief The sum, mean and variance of the last N values of a stream.
+//! \details The values are kept in a cyclic_deque. When the window is full, a
+//! push() evicts the oldest value. Each push and eviction updates the running
+//! statistics in O(1), such that every query is O(1):
+//! * The sum is a Neumaier compensated sum, which keeps the rounding error
+//! independent of the number of values added and removed.
+//! * The mean and the sum of squared deviations are updated with Welford's
+//! algorithm, extended with the inverse update for evictions.
+//!
+//! Removing values from a floating-point accumulator doesn't exactly undo
+//! adding them, so errors slowly accumulate. The statistics are therefore
+//! recomputed exactly from the window after every recompute_interval()
+//! pushes. The default interval equals the size of the window, which keeps
+//! push() amortized O(1).
+template <typename T_, typename Allocator_ = std::allocator<T_>>
+class windowed_stats {
+  static_assert(
+      std::is_arithmetic_v<T_>,
+      "ouroboros::windowed_stats requires an arithmetic value_type");
+
+  using container = cyclic_deque<T_, Allocator_>;
+
+ public:
+  using allocator_type = Allocator_;
+  using size_type = std::size_t;
+  using value_type = T_;
+  //! \brief The type of the statistics. At least a double.
+  using result_type = std::common_type_t<T_, double>;
+
+  //! \brief Create a window of the last \p n values. The statistics are
+  //! recomputed after every \p recompute_interval pushes. An interval of zero
+  //! selects \p n.
+  explicit windowed_stats(
+      size_type n,
+      size_type recompute_interval = 0,
+      allocator_type const& a = allocator_type())
+      : window_(n, a),
+        interval_(recompute_interval > 0 ? recompute_interval : n),
+        updates_(0) {
+    assert(n > 0);
+    reset();
+  }
+
+  //! \brief Add \p value to the window, evicting the oldest value when the
+  //! window is full.
+  void push(value_type value) {
+    if (window_.full()) {
+      remove(static_cast<result_type>(window_.front()));
+      window_.pop_front();
+    }
+    window_.push_back(value);
+    add(static_cast<result_type>(value));
+    if (++updates_ >= interval_) {
+      recompute();
+    }
+  }
+
+  //! \brief Remove the oldest value.
+  //! \details Undefined behavior if the window is empty.
+  void pop() {
+    assert(!empty());
+    remove(static_cast<result_type>(window_.front()));
+    window_.pop_front();
+    if (window_.empty()) {
+      reset();
+    }
+  }
+
+  //! \brief Remove all values.
+  void clear() noexcept {
+    window_.clear();
+    reset();
+  }
+
+  //! \brief Recompute the statistics exactly from the values in the window.
+  //! This is O(N).
+  void recompute() noexcept {
+    reset();
+    if (window_.empty()) {
+      return;
+    }
+    for (auto const& s : window_.used_segments()) {
+      for (value_type v : s) {
+        add_sum(static_cast<result_type>(v));
+      }
+    }
+    // Two passes, such that the squared deviations are summed without
+    // cancellation.
+    result_type mean = sum() / static_cast<result_type>(window_.size());
+    result_type m2 = 0;
+    result_type c = 0;
+    for (auto const& s : window_.used_segments()) {
+      for (value_type v : s) {
+        result_type d = static_cast<result_type>(v) - mean;
+        c += d;
+        m2 += d * d;
+      }
+    }
+    // Corrects for the rounding error of the mean.
+    m2 -= c * c / static_cast<result_type>(window_.size());
+    mean_ = mean + c / static_cast<result_type>(window_.size());
+    m2_ = m2 > 0 ? m2 : 0;
+    count_ = window_.size();
+  }
+
+  //! \brief Return the sum of the values in the window.
+  result_type sum() const noexcept { return sum_ + compensation_; }
+
+  //! \brief Return the mean of the values in the window, or zero when it is
+  //! empty.
+  result_type mean() const noexcept { return mean_; }
+
+  //! \brief Return the population variance of the values in the window, or
+  //! zero when it is empty.
+  result_type variance() const noexcept {
+    return count_ > 0 ? m2_ / static_cast<result_type>(count_) : 0;
+  }
+
+  //! \brief Return the sample variance of the values in the window, or zero
+  //! when it holds less than two values.
+  result_type sample_variance() const noexcept {
+    return count_ > 1 ? m2_ / static_cast<result_type>(count_ - 1) : 0;
+  }
+
+  //! \brief Return the population standard deviation.
+  result_type stddev() const noexcept { return std::sqrt(variance()); }
+
+  //! \brief Return the sample standard deviation.
+  result_type sample_stddev() const noexcept {
+    return std::sqrt(sample_variance());
+  }
+
+  //! \brief Return the values in the window, oldest first.
+  container const& window() const noexcept { return window_; }
+
+  //! \brief Return the number of values in the window.
+  size_type size() const noexcept { return window_.size(); }
+
+  //! \brief Return the maximum number of values in the window.
+  size_type capacity() const noexcept { return window_.capacity(); }
+
+  //! \brief Return true if the window is empty.
+  bool empty() const noexcept { return window_.empty(); }
+
+  //! \brief Return true if the window is full.
+  bool full() const noexcept { return window_.full(); }
+
+  //! \brief Return the number of pushes after which the statistics are
+  //! recomputed.
+  size_type recompute_interval() const noexcept { return interval_; }
+
+ private:
+  void reset() noexcept {
+    sum_ = 0;
+    compensation_ = 0;
+    mean_ = 0;
+    m2_ = 0;
+    count_ = 0;
+    updates_ = 0;
+  }
+
+  void add_sum(result_type x) noexcept {
+    result_type t = sum_ + x;
+    if (std::abs(sum_) >= std::abs(x)) {
+      compensation_ += (sum_ - t) + x;
+    } else {
+      compensation_ += (x - t) + sum_;
+    }
+    sum_ = t;
+  }
+
+  void add(result_type x) noexcept {
+    add_sum(x);
+    ++count_;
+    result_type d = x - mean_;
+    mean_ += d / static_cast<result_type>(count_);
+    m2_ += d * (x - mean_);
+  }
+
+  void remove(result_type x) noexcept {
+    add_sum(-x);
+    if (--count_ == 0) {
+      mean_ = 0;
+      m2_ = 0;
+      return;
+    }
+    result_type d = x - mean_;
+    mean_ -= d / static_cast<result_type>(count_);
+    m2_ -= d * (x - mean_);
+    if (m2_ < 0) {
+      m2_ = 0;
+    }
+  }
+
+  container window_;
+  size_type interval_;
+  size_type updates_;
+  result_type sum_;
+  result_type compensation_;
+  result_type mean_;
+  result_type m2_;
+  size_type count_;
+};
+
+}  // namespace ouroboros
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "concurrency.hpp"
+
+namespace ouroboros {
+
+//! \brief A lock-free, growable work-stealing deque (Chase-Lev).
+//! \details The owner thread pushes and pops elements at the bottom, in LIFO
+//! order. Any other thread may steal elements from the top, in FIFO order,
+//! using a compare-and-swap. The memory orders follow "Correct and Efficient
+//! Work-Stealing for Weak Memory Models" by Lê et al.
+//!
+//! The elements are stored in a cyclic buffer that is indexed with a mask.
+//! When the owner pushes onto a full buffer, the elements are copied into a
+//! buffer of twice the size. Old buffers are kept alive until the deque is
+//! destroyed because thieves may still be reading from them. The value_type
+//! must be trivially copyable, such as a pointer or an index, because elements
+//! are stored in atomics.
+template <typename T_>
+class ws_deque {
+  static_assert(
+      std::is_trivially_copyable_v<T_>,
+      "ouroboros::ws_deque requires a trivially copyable value_type");
+
+  class buffer {
+   public:
+    explicit buffer(std::int64_t capacity)
+        : mask_(capacity - 1), elements_(new std::atomic<T_>[capacity]) {}
+
+    std::int64_t capacity() const noexcept { return mask_ + 1; }
+
+    T_ get(std::int64_t i) const noexcept {
+      return elements_[i & mask_].load(std::memory_order_relaxed);
+    }
+
+    void put(std::int64_t i, T_ value) noexcept {
+      elements_[i & mask_].store(value, std::memory_order_relaxed);
+    }
+
+    //! \brief Return a copy of the buffer with twice the capacity that
+    //! contains the elements in range [top...bottom).
+    std::unique_ptr<buffer> grow(
+        std::int64_t top, std::int64_t bottom) const {
+      auto b = std::make_unique<buffer>(capacity() * 2);
+      for (std::int64_t i = top; i < bottom; ++i) {
+        b->put(i, get(i));
+      }
+      return b;
+    }
+
+   private:
+    std::int64_t mask_;
+    std::unique_ptr<std::atomic<T_>[]> elements_;
+  };
+
+ public:
+  using size_type = std::size_t;
+  using value_type = T_;
+
+  //! \brief Create a deque with an initial capacity of at least \p c.
+  explicit ws_deque(size_type c = 64)
+      : top_(0),
+        bottom_(0),
+        buffer_(nullptr) {
+    buffers_.push_back(std::make_unique<buffer>(
+        static_cast<std::int64_t>(internal::ceil_power_of_two(c))));
+    buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+  }
+
+  ws_deque(ws_deque const&) = delete;
+
+  ws_deque& operator=(ws_deque const&) = delete;
+
+  //! \brief Add an element to the bottom. Grows the deque when it is full.
+  //! Owner only.
+  void push(value_type value) {
+    std::int64_t b = bottom_.load(std::memory_order_relaxed);
+    std::int64_t t = top_.load(std::memory_order_acquire);
+    buffer* a = buffer_.load(std::memory_order_relaxed);
+    if (b - t > a->capacity() - 1) {
+      buffers_.push_back(a->grow(t, b));
+      a = buffers_.back().get();
+      buffer_.store(a, std::memory_order_release);
+    }
+    a->put(b, value);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+  }
+
+  //! \brief Remove the bottom element and copy it into \p value. Returns false
+  //! if the deque is empty or a thief took the last element, in which case
+  //! \p value is left untouched. Owner only.
+  bool pop(value_type& value) noexcept {
+    std::int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    buffer* a = buffer_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t t = top_.load(std::memory_order_relaxed);
+    bool found = false;
+    if (t <= b) {
+      value_type v = a->get(b);
+      found = true;
+      if (t == b) {
+        // The last element. Race the thieves for it.
+        found = top_.compare_exchange_strong(
+            t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+      }
+      if (found) {
+        value = v;
+      }
+    } else {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return found;
+  }
+
+  //! \brief Remove the top element and copy it into \p value. Returns false if
+  //! the deque is empty or if another thread won the race for the element.
+  //! Any thread.
+  bool steal(value_type& value) noexcept {
+    std::int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t < b) {
+      buffer* a = buffer_.load(std::memory_order_acquire);
+      value_type v = a->get(t);
+      if (top_.compare_exchange_strong(
+              t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        value = v;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  //! \brief Return the approximate number of elements.
+  size_type size() const noexcept {
+    std::int64_t b = bottom_.load(std::memory_order_relaxed);
+    std::int64_t t = top_.load(std::memory_order_relaxed);
+    return b > t ? static_cast<size_type>(b - t) : 0;
+  }
+
+  //! \brief Return true if the deque is approximately empty.
+  bool empty() const noexcept { return size() == 0; }
+
+  //! \brief Return the capacity of the current buffer. Owner only.
+  size_type capacity() const noexcept {
+    return static_cast<size_type>(
+        buffer_.load(std::memory_order_relaxed)->capacity());
+  }
+
+ private:
+  // Stolen from by thieves.
+  alignas(internal::cache_line_size) std::atomic<std::int64_t> top_;
+  // Written by the owner.
+  alignas(internal::cache_line_size) std::atomic<std::int64_t> bottom_;
+  std::atomic<buffer*> buffer_;
+  std::vector<std::unique_ptr<buffer>> buffers_;
+};
+
+}  // namespace ouroboros
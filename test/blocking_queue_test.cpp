@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <ouroboros/blocking_queue.hpp>
+#include <ouroboros/mpmc_cyclic_queue.hpp>
+#include <ouroboros/mpsc_cyclic_queue.hpp>
+#include <ouroboros/spsc_cyclic_queue.hpp>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Producers push more elements than fit in the queue, such that both
+// producers and consumers have to wait.
+template <typename Queue_>
+void ProducersConsumers(
+    std::size_t producers, std::size_t consumers, std::size_t count = 20000) {
+  Queue_ queue(4);
+  std::atomic<std::size_t> sum{0};
+
+  std::vector<std::thread> threads;
+  for (std::size_t p = 0; p < producers; ++p) {
+    threads.emplace_back([&queue, count]() {
+      for (std::size_t i = 1; i <= count; ++i) {
+        queue.push(i);
+      }
+    });
+  }
+  for (std::size_t c = 0; c < consumers; ++c) {
+    threads.emplace_back([&]() {
+      std::size_t v;
+      for (std::size_t i = 0; i < producers * count / consumers; ++i) {
+        queue.pop(v);
+        sum += v;
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(sum.load(), producers * count * (count + 1) / 2);
+  EXPECT_TRUE(queue.empty());
+}
+
+template <typename WaitStrategy_>
+void PopFor() {
+  ouroboros::blocking_queue<
+      ouroboros::mpmc_cyclic_queue<int>,
+      WaitStrategy_>
+      queue(2);
+  int v;
+  auto begin = std::chrono::steady_clock::now();
+  EXPECT_FALSE(queue.pop_for(v, std::chrono::milliseconds(20)));
+  EXPECT_GE(
+      std::chrono::steady_clock::now() - begin, std::chrono::milliseconds(20));
+
+  EXPECT_TRUE(queue.try_push(1));
+  EXPECT_TRUE(queue.try_push(2));
+  EXPECT_FALSE(queue.try_push(3));
+  EXPECT_TRUE(queue.pop_for(v, std::chrono::milliseconds(20)));
+  EXPECT_EQ(v, 1);
+  EXPECT_TRUE(queue.try_pop(v));
+  EXPECT_EQ(v, 2);
+  EXPECT_FALSE(queue.try_pop(v));
+
+  // Woken up by a push from another thread.
+  std::thread producer([&queue]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    queue.push(4);
+  });
+  EXPECT_TRUE(queue.pop_for(v, std::chrono::seconds(10)));
+  EXPECT_EQ(v, 4);
+  producer.join();
+}
+
+}  // namespace
+
+TEST(BlockingQueueTest, SpinWait) {
+  PopFor<ouroboros::spin_wait>();
+  // Spinning threads only make progress when preempted on a single core.
+  ProducersConsumers<ouroboros::blocking_queue<
+      ouroboros::spsc_cyclic_queue<std::size_t>,
+      ouroboros::spin_wait>>(1, 1, 100);
+}
+
+TEST(BlockingQueueTest, YieldWait) {
+  PopFor<ouroboros::yield_wait>();
+  ProducersConsumers<ouroboros::blocking_queue<
+      ouroboros::mpsc_cyclic_queue<std::size_t>,
+      ouroboros::yield_wait>>(3, 1);
+}
+
+TEST(BlockingQueueTest, FutexWait) {
+  PopFor<ouroboros::futex_wait>();
+  ProducersConsumers<ouroboros::blocking_queue<
+      ouroboros::spsc_cyclic_queue<std::size_t>,
+      ouroboros::futex_wait>>(1, 1);
+  ProducersConsumers<ouroboros::blocking_queue<
+      ouroboros::mpmc_cyclic_queue<std::size_t>,
+      ouroboros::futex_wait>>(2, 2);
+}
+
+TEST(BlockingQueueTest, FutexWaitParked) {
+  // Each push wakes a single parked consumer, and no wakeup is lost.
+  constexpr int consumers = 4;
+  ouroboros::blocking_queue<
+      ouroboros::mpmc_cyclic_queue<std::size_t>,
+      ouroboros::futex_wait>
+      queue(8);
+  std::atomic<std::size_t> sum{0};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < consumers; ++i) {
+    threads.emplace_back([&]() {
+      std::size_t v;
+      queue.pop(v);
+      sum += v;
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  for (std::size_t i = 1; i <= consumers; ++i) {
+    queue.push(i);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(sum.load(), 10);
+}
+
+TEST(BlockingQueueTest, FutexWaitNotifyAll) {
+  ouroboros::futex_wait wait;
+  std::atomic<bool> closed{false};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 3; ++i) {
+    threads.emplace_back([&]() { wait.wait([&]() { return closed.load(); }); });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  closed = true;
+  wait.notify_all();
+  for (auto& t : threads) {
+    t.join();
+  }
+}
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <ouroboros/broadcast_ring.hpp>
+#include <thread>
+#include <vector>
+
+TEST(BroadcastRingTest, Readers) {
+  ouroboros::broadcast_ring<std::uint64_t> ring(4);
+  EXPECT_EQ(ring.capacity(), 4);
+  auto a = ring.make_reader();
+  ring.push(0);
+  ring.push(1);
+  auto b = ring.make_reader();
+
+  std::uint64_t v;
+  EXPECT_EQ(b.try_read(v), ouroboros::read_status::empty);
+  ring.push(2);
+  EXPECT_EQ(a.try_read(v), ouroboros::read_status::ok);
+  EXPECT_EQ(v, 0);
+  EXPECT_EQ(b.try_read(v), ouroboros::read_status::ok);
+  EXPECT_EQ(v, 2);
+  EXPECT_EQ(a.lag(), 2);
+
+  // Reader a is at position 1. Overwrite it.
+  for (std::uint64_t i = 3; i < 8; ++i) {
+    ring.push(i);
+  }
+  EXPECT_EQ(a.try_read(v), ouroboros::read_status::lapped);
+  EXPECT_EQ(a.missed(), 4);
+  std::vector<std::uint64_t> rest;
+  while (a.try_read(v) == ouroboros::read_status::ok) {
+    rest.push_back(v);
+  }
+  EXPECT_EQ(rest, (std::vector<std::uint64_t>{5, 6, 7}));
+
+  auto c = ring.make_reader_from_oldest();
+  EXPECT_EQ(c.try_read(v), ouroboros::read_status::ok);
+  EXPECT_EQ(v, 5);
+}
+
+TEST(BroadcastRingTest, Oldest) {
+  ouroboros::broadcast_ring<std::uint64_t> ring(4);
+  auto a = ring.make_reader();
+  std::uint64_t v;
+  for (std::uint64_t i = 0; i < 3; ++i) {
+    ring.push(i);
+  }
+  EXPECT_EQ(ring.make_reader_from_oldest().lag(), 3);
+
+  // A full ring. The oldest element is overwritten by the next write, and is
+  // skipped by both a new reader and a lapped reader.
+  ring.push(3);
+  auto b = ring.make_reader_from_oldest();
+  EXPECT_EQ(b.lag(), 3);
+  ring.push(4);
+  EXPECT_EQ(a.try_read(v), ouroboros::read_status::lapped);
+  EXPECT_EQ(a.missed(), 2);
+  EXPECT_EQ(a.try_read(v), ouroboros::read_status::ok);
+  EXPECT_EQ(v, 2);
+  EXPECT_EQ(b.try_read(v), ouroboros::read_status::ok);
+  EXPECT_EQ(v, 1);
+}
+
+namespace {
+
+struct Pair {
+  std::uint64_t a;
+  std::uint64_t b;
+};
+
+}  // namespace
+
+TEST(BroadcastRingTest, ConsistentReads) {
+  constexpr std::uint64_t count = 200000;
+  ouroboros::broadcast_ring<Pair> ring(16);
+  std::atomic<bool> done{false};
+  std::atomic<bool> consistent{true};
+
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 3; ++r) {
+    readers.emplace_back([&]() {
+      auto reader = ring.make_reader_from_oldest();
+      std::uint64_t last = 0;
+      std::uint64_t read = 0;
+      Pair p;
+      while (!done.load() || reader.lag() > 0) {
+        auto status = reader.try_read(p);
+        if (status == ouroboros::read_status::ok) {
+          // Elements are never torn and always arrive in order.
+          if (p.a != ~p.b || (read > 0 && p.a <= last)) {
+            consistent = false;
+          }
+          last = p.a;
+          ++read;
+        } else if (status == ouroboros::read_status::empty) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  for (std::uint64_t i = 0; i < count; ++i) {
+    ring.push({i, ~i});
+  }
+  done = true;
+  for (auto& r : readers) {
+    r.join();
+  }
+  EXPECT_TRUE(consistent.load());
+  EXPECT_EQ(ring.written(), count);
+}
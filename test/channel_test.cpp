@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <ouroboros/channel.hpp>
+#include <vector>
+
+namespace {
+
+ouroboros::detached_task Produce(
+    ouroboros::channel<int>& ch, int count, bool close) {
+  for (int i = 0; i < count; ++i) {
+    EXPECT_TRUE(co_await ch.push(i));
+  }
+  if (close) {
+    ch.close();
+  }
+}
+
+ouroboros::detached_task Consume(
+    ouroboros::channel<int>& ch, std::vector<int>& out) {
+  while (auto v = co_await ch.pop()) {
+    out.push_back(*v);
+  }
+}
+
+}  // namespace
+
+TEST(ChannelTest, TryPushPop) {
+  ouroboros::executor e;
+  ouroboros::channel<int> ch(e, 2);
+  EXPECT_EQ(ch.capacity(), 2);
+  EXPECT_FALSE(ch.try_pop());
+  EXPECT_TRUE(ch.try_push(1));
+  EXPECT_TRUE(ch.try_push(2));
+  EXPECT_FALSE(ch.try_push(3));
+  EXPECT_EQ(ch.size(), 2);
+  EXPECT_EQ(ch.try_pop(), 1);
+  EXPECT_EQ(ch.try_pop(), 2);
+  EXPECT_TRUE(ch.empty());
+
+  ch.close();
+  EXPECT_TRUE(ch.closed());
+  EXPECT_FALSE(ch.try_push(4));
+  EXPECT_TRUE(e.empty());
+}
+
+TEST(ChannelTest, ProducerConsumer) {
+  // A capacity of zero hands each element directly to the consumer.
+  for (std::size_t capacity : {0, 1, 3, 64}) {
+    ouroboros::executor e(1);
+    ouroboros::channel<int> ch(e, capacity);
+    std::vector<int> out;
+    e.spawn(Consume(ch, out));
+    e.spawn(Produce(ch, 100, true));
+    e.run();
+    EXPECT_TRUE(e.empty());
+    ASSERT_EQ(out.size(), 100);
+    for (int i = 0; i < 100; ++i) {
+      EXPECT_EQ(out[i], i);
+    }
+  }
+}
+
+TEST(ChannelTest, ManyProducers) {
+  ouroboros::executor e;
+  ouroboros::channel<int> ch(e, 2);
+  std::vector<int> out;
+  for (int p = 0; p < 4; ++p) {
+    e.spawn(Produce(ch, 10, false));
+  }
+  e.spawn(Consume(ch, out));
+  e.run();
+  // All producers are done. The consumer waits for more.
+  EXPECT_EQ(out.size(), 40);
+  EXPECT_TRUE(e.empty());
+  ch.close();
+  e.run();
+  EXPECT_EQ(out.size(), 40);
+}
+
+TEST(ChannelTest, CloseResumesPushers) {
+  ouroboros::executor e;
+  ouroboros::channel<std::unique_ptr<int>> ch(e, 1);
+  std::vector<bool> results;
+  auto push = [](ouroboros::channel<std::unique_ptr<int>>& ch,
+                 std::vector<bool>& results) -> ouroboros::detached_task {
+    results.push_back(co_await ch.push(std::make_unique<int>(1)));
+  };
+  e.spawn(push(ch, results));
+  e.spawn(push(ch, results));
+  e.run();
+  EXPECT_EQ(results, (std::vector<bool>{true}));
+  ch.close();
+  e.run();
+  EXPECT_EQ(results, (std::vector<bool>{true, false}));
+  // The buffered element survives closing the channel.
+  auto v = ch.try_pop();
+  ASSERT_TRUE(v);
+  EXPECT_EQ(**v, 1);
+}
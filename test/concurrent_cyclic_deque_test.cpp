@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <iterator>
+#include <stdexcept>
+#include <ouroboros/concurrent_cyclic_deque.hpp>
+#include <thread>
+#include <vector>
+
+TEST(ConcurrentCyclicDequeTest, PushPop) {
+  ouroboros::concurrent_cyclic_deque<int> deque(4);
+  EXPECT_EQ(deque.capacity(), 4);
+
+  int v;
+  EXPECT_FALSE(deque.try_pop_front(v));
+  EXPECT_FALSE(deque.try_pop_back(v));
+  // Wraps around in both directions.
+  for (int lap = 0; lap < 3; ++lap) {
+    EXPECT_TRUE(deque.try_push_back(2));
+    EXPECT_TRUE(deque.try_push_front(1));
+    EXPECT_TRUE(deque.try_push_back(3));
+    EXPECT_TRUE(deque.try_push_front(0));
+    EXPECT_FALSE(deque.try_push_back(4));
+    EXPECT_FALSE(deque.try_push_front(4));
+    EXPECT_EQ(deque.size(), 4);
+
+    EXPECT_TRUE(deque.try_pop_back(v));
+    EXPECT_EQ(v, 3);
+    EXPECT_TRUE(deque.try_pop_front(v));
+    EXPECT_EQ(v, 0);
+    EXPECT_TRUE(deque.try_pop_front(v));
+    EXPECT_EQ(v, 1);
+    EXPECT_TRUE(deque.try_pop_back(v));
+    EXPECT_EQ(v, 2);
+    EXPECT_TRUE(deque.empty());
+  }
+}
+
+TEST(ConcurrentCyclicDequeTest, Bulk) {
+  ouroboros::concurrent_cyclic_deque<int> deque(8);
+  std::vector<int> in = {0, 1, 2, 3, 4, 5};
+  EXPECT_EQ(deque.try_push_back_n(in.begin() + 3, 3), 3);
+  // Pushed to the front one at a time.
+  EXPECT_EQ(deque.try_push_front_n(in.rbegin() + 3, 3), 3);
+  // Partially full.
+  EXPECT_EQ(deque.try_push_back_n(in.begin(), 6), 2);
+  EXPECT_EQ(deque.size(), 8);
+
+  std::vector<int> out;
+  EXPECT_EQ(deque.try_pop_front_n(std::back_inserter(out), 4), 4);
+  EXPECT_EQ(out, (std::vector<int>{0, 1, 2, 3}));
+  out.clear();
+  EXPECT_EQ(deque.try_pop_back_n(std::back_inserter(out), 3), 3);
+  EXPECT_EQ(out, (std::vector<int>{1, 0, 5}));
+  out.clear();
+  EXPECT_EQ(deque.try_pop_back_n(std::back_inserter(out), 3), 1);
+  EXPECT_EQ(out, (std::vector<int>{4}));
+  EXPECT_EQ(deque.try_pop_front_n(std::back_inserter(out), 3), 0);
+  EXPECT_TRUE(deque.empty());
+}
+
+namespace {
+
+// Throws when converted to or assigned a negative value.
+struct throwing {
+  throwing& operator=(int v) {
+    if (v < 0) {
+      throw std::runtime_error("negative");
+    }
+    value = v;
+    return *this;
+  }
+
+  operator int() const {
+    if (value < 0) {
+      throw std::runtime_error("negative");
+    }
+    return value;
+  }
+
+  int value;
+};
+
+}  // namespace
+
+TEST(ConcurrentCyclicDequeTest, Exceptions) {
+  // The elements moved before an exception stay moved and no capacity is
+  // lost.
+  ouroboros::concurrent_cyclic_deque<int> deque(4);
+  std::vector<throwing> in = {{0}, {1}, {-1}, {2}};
+  EXPECT_THROW(deque.try_push_back_n(in.begin(), 4), std::runtime_error);
+  EXPECT_EQ(deque.size(), 2);
+  EXPECT_THROW(deque.try_push_front_n(in.rbegin(), 2), std::runtime_error);
+  EXPECT_EQ(deque.size(), 3);
+  EXPECT_TRUE(deque.try_push_back(-2));
+  EXPECT_FALSE(deque.try_push_back(3));
+
+  throwing out[4] = {};
+  EXPECT_THROW(deque.try_pop_back_n(out, 4), std::runtime_error);
+  EXPECT_EQ(deque.size(), 4);
+  int v;
+  EXPECT_TRUE(deque.try_pop_back(v));
+  EXPECT_EQ(v, -2);
+  EXPECT_EQ(deque.try_pop_front_n(out, 4), 3);
+  EXPECT_EQ(out[0].value, 2);
+  EXPECT_EQ(out[1].value, 0);
+  EXPECT_EQ(out[2].value, 1);
+  EXPECT_TRUE(deque.empty());
+  EXPECT_EQ(deque.try_push_back_n(in.begin(), 2), 2);
+  EXPECT_EQ(deque.try_push_front_n(in.rbegin(), 1), 1);
+  EXPECT_EQ(deque.size(), 3);
+}
+
+TEST(ConcurrentCyclicDequeTest, BothEnds) {
+  // Every thread pushes at one end and pops at either end. The small capacity
+  // makes the deque switch between the fast and the exclusive paths.
+  constexpr std::size_t threads_per_end = 2;
+  constexpr std::size_t count = 20000;
+  ouroboros::concurrent_cyclic_deque<std::size_t> deque(16);
+  std::atomic<std::size_t> popped{0};
+  std::atomic<std::size_t> sum{0};
+
+  auto pop = [&](bool front) {
+    std::size_t v[4];
+    std::size_t n = front ? deque.try_pop_front_n(v, 4)
+                          : deque.try_pop_back_n(v, 4);
+    for (std::size_t i = 0; i < n; ++i) {
+      sum += v[i];
+    }
+    popped += n;
+  };
+
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < 2 * threads_per_end; ++t) {
+    threads.emplace_back([&, t]() {
+      bool front = t % 2 == 0;
+      for (std::size_t i = 1; i <= count; ++i) {
+        while (!(front ? deque.try_push_front(i) : deque.try_push_back(i))) {
+          pop(!front);
+          std::this_thread::yield();
+        }
+        if (i % 2 == 0) {
+          pop(front);
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  while (!deque.empty()) {
+    pop(true);
+  }
+  EXPECT_EQ(popped.load(), 2 * threads_per_end * count);
+  EXPECT_EQ(sum.load(), 2 * threads_per_end * count * (count + 1) / 2);
+}
@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <numeric>
+#include <ouroboros/blocking_queue.hpp>
+#include <ouroboros/contention_stats.hpp>
+#include <ouroboros/mpmc_cyclic_queue.hpp>
+#include <ouroboros/mpsc_cyclic_queue.hpp>
+#include <ouroboros/spsc_cyclic_queue.hpp>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+using stats = ouroboros::contention_stats;
+
+TEST(ContentionStatsTest, Buckets) {
+  EXPECT_EQ(stats::bucket(0), 0);
+  EXPECT_EQ(stats::bucket(1), 1);
+  EXPECT_EQ(stats::bucket(2), 2);
+  EXPECT_EQ(stats::bucket(3), 2);
+  EXPECT_EQ(stats::bucket(1024), 11);
+  EXPECT_EQ(stats::bucket(std::uint64_t(-1)), stats::bucket_count - 1);
+
+  for (std::size_t i = 1; i < stats::bucket_count; ++i) {
+    auto floor = static_cast<std::uint64_t>(stats::bucket_floor(i).count());
+    EXPECT_EQ(stats::bucket(floor), i);
+    EXPECT_EQ(stats::bucket(floor - 1), i - 1);
+  }
+}
+
+TEST(ContentionStatsTest, NoStats) {
+  ouroboros::spsc_cyclic_queue<int> q(1);
+  EXPECT_FALSE(decltype(q)::stats_type::enabled);
+  EXPECT_TRUE(std::is_empty_v<decltype(q)::stats_type>);
+}
+
+TEST(ContentionStatsTest, Noexcept) {
+  // The policy doesn't change the exception guarantees of a queue.
+  stats s;
+  EXPECT_TRUE(noexcept(s.cas_retry()));
+  EXPECT_TRUE(noexcept(s.full()));
+  EXPECT_TRUE(noexcept(s.empty()));
+  EXPECT_TRUE(noexcept(s.park()));
+  EXPECT_TRUE(noexcept(s.unpark()));
+  EXPECT_TRUE(noexcept(s.wait_stop(s.wait_start())));
+}
+
+TEST(ContentionStatsTest, FullEmpty) {
+  ouroboros::spsc_cyclic_queue<int, std::allocator<int>, stats> q(2);
+  int v;
+  EXPECT_FALSE(q.try_pop(v));
+  EXPECT_TRUE(q.try_push(1));
+  EXPECT_TRUE(q.try_push(2));
+  EXPECT_FALSE(q.try_push(3));
+  EXPECT_FALSE(q.try_push(3));
+  int values[2];
+  EXPECT_EQ(q.try_pop_n(values, 2), 2);
+  EXPECT_EQ(q.try_pop_n(values, 2), 0);
+  // Transferring no elements doesn't count as a full or empty queue.
+  EXPECT_TRUE(q.try_push(1));
+  EXPECT_EQ(q.try_push_n(values, 0), 0);
+  EXPECT_EQ(q.try_pop_n(values, 0), 0);
+
+  auto s = q.stats().collect();
+  EXPECT_EQ(s.full, 2);
+  EXPECT_EQ(s.empty, 2);
+  EXPECT_EQ(s.cas_retries, 0);
+  EXPECT_EQ(s.waits, 0);
+
+  ouroboros::mpmc_cyclic_queue<int, std::allocator<int>, stats> m(2);
+  EXPECT_TRUE(m.try_push(1));
+  EXPECT_TRUE(m.try_push(2));
+  EXPECT_FALSE(m.try_push(3));
+  EXPECT_TRUE(m.try_pop(v));
+  EXPECT_TRUE(m.try_pop(v));
+  EXPECT_FALSE(m.try_pop(v));
+  s = m.stats().collect();
+  EXPECT_EQ(s.full, 1);
+  EXPECT_EQ(s.empty, 1);
+}
+
+TEST(ContentionStatsTest, Threads) {
+  constexpr int threads = 4;
+  constexpr int count = 200;
+  ouroboros::mpsc_cyclic_queue<int, std::allocator<int>, stats> q(4);
+
+  std::vector<std::thread> producers;
+  for (int t = 0; t < threads; ++t) {
+    producers.emplace_back([&q]() {
+      for (int i = 0; i < count; ++i) {
+        auto c = q.claim(1);
+        c[0] = i;
+        q.publish(c);
+      }
+    });
+  }
+  int consumed = 0;
+  while (consumed < threads * count) {
+    consumed += static_cast<int>(q.consume([](auto const&) {}));
+  }
+  for (auto& p : producers) {
+    p.join();
+  }
+
+  // Each thread counted into a record of its own. The producers waited for
+  // the consumer, the consumer for the producers.
+  auto s = q.stats().collect();
+  EXPECT_GT(s.full, 0);
+  EXPECT_GT(s.empty, 0);
+  EXPECT_GT(s.waits, 0);
+  EXPECT_EQ(
+      std::accumulate(
+          s.wait_histogram.begin(), s.wait_histogram.end(), std::uint64_t(0)),
+      s.waits);
+}
+
+TEST(ContentionStatsTest, ExitedThreads) {
+  // The counters of exited threads are kept after their records are dropped.
+  ouroboros::mpmc_cyclic_queue<int, std::allocator<int>, stats> q(2);
+  for (int i = 0; i < 1000; ++i) {
+    std::thread([&q, i]() {
+      int v;
+      EXPECT_FALSE(q.try_pop(v));
+      EXPECT_TRUE(q.try_push(i));
+      EXPECT_TRUE(q.try_push(i));
+      EXPECT_FALSE(q.try_push(i));
+      EXPECT_TRUE(q.try_pop(v));
+      EXPECT_TRUE(q.try_pop(v));
+    }).join();
+    EXPECT_EQ(q.stats().record_count(), 0);
+  }
+  auto s = q.stats().collect();
+  EXPECT_EQ(s.full, 1000);
+  EXPECT_EQ(s.empty, 1000);
+}
+
+TEST(ContentionStatsTest, ParkUnpark) {
+  ouroboros::blocking_queue<
+      ouroboros::mpmc_cyclic_queue<int, std::allocator<int>, stats>,
+      ouroboros::futex_wait>
+      q(4);
+
+  std::thread consumer([&q]() {
+    int v;
+    q.pop(v);
+    EXPECT_EQ(v, 42);
+  });
+  // Give the consumer time to park.
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  q.push(42);
+  consumer.join();
+
+  auto s = q.stats().collect();
+  EXPECT_EQ(s.waits, 1);
+  EXPECT_GE(s.parks, 1);
+  EXPECT_GE(s.unparks, 1);
+  EXPECT_GE(s.empty, 1);
+  EXPECT_GE(s.wait_time, std::chrono::milliseconds(10));
+  auto ns = static_cast<std::uint64_t>(s.wait_time.count());
+  EXPECT_EQ(s.wait_histogram[stats::bucket(ns)], 1);
+
+  int v;
+  EXPECT_FALSE(q.pop_for(v, std::chrono::milliseconds(1)));
+  EXPECT_EQ(q.stats().collect().waits, 2);
+}
@@ -354,3 +354,67 @@ TEST(CyclicDequeTest, StrongExceptionSafety) {
   EXPECT_EQ(&cdeque[0], ptr_0);
   EXPECT_EQ(&cdeque[initial_size - 1], ptr_N);
 }
+
+TEST(CyclicDequeTest, PopFrontBackN) {
+  ouroboros::cyclic_deque<std::size_t> cdeque(4);
+  cdeque.append_range(std::vector<std::size_t>{0, 1, 2, 3});
+  cdeque.pop_front(3);
+  ExpectCapacityAndSize(cdeque, 4, 1);
+  EXPECT_EQ(cdeque.front(), 3);
+  cdeque.append_range(std::vector<std::size_t>{4, 5, 6});
+  cdeque.pop_back(2);
+  ExpectCapacityAndSize(cdeque, 4, 2);
+  EXPECT_EQ(cdeque.front(), 3);
+  EXPECT_EQ(cdeque.back(), 4);
+  cdeque.pop_front(2);
+  EXPECT_TRUE(cdeque.empty());
+}
+
+TEST(CyclicDequeTest, Segments) {
+  ouroboros::cyclic_deque<std::size_t> cdeque(6);
+  {
+    auto used = cdeque.used_segments();
+    auto free = cdeque.free_segments();
+    EXPECT_TRUE(used[0].empty());
+    EXPECT_TRUE(used[1].empty());
+    EXPECT_EQ(free[0].size(), 6);
+    EXPECT_TRUE(free[1].empty());
+  }
+
+  cdeque.append_range(std::vector<std::size_t>{0, 1, 2, 3, 4});
+  cdeque.pop_front(3);
+  cdeque.append_range(std::vector<std::size_t>{5, 6});
+  // Buffer: [6 _ _ 3 4 5]
+  {
+    auto used = cdeque.used_segments();
+    ASSERT_EQ(used[0].size(), 3);
+    ASSERT_EQ(used[1].size(), 1);
+    EXPECT_EQ(used[0].data(), &cdeque[0]);
+    EXPECT_EQ(used[1].data(), &cdeque[3]);
+    std::size_t expected = 3;
+    for (auto const& s : used) {
+      for (auto v : s) {
+        EXPECT_EQ(v, expected++);
+      }
+    }
+
+    auto free = cdeque.free_segments();
+    EXPECT_EQ(free[0].size(), 2);
+    EXPECT_EQ(free[0].data(), &cdeque[3] + 1);
+    EXPECT_TRUE(free[1].empty());
+
+    // Writing into the free segments and committing them with resize().
+    free[0][0] = 7;
+    free[0][1] = 8;
+    cdeque.resize(cdeque.size() + 2);
+    EXPECT_TRUE(cdeque.full());
+    EXPECT_EQ(cdeque.back(), 8);
+  }
+
+  auto const& const_cdeque = cdeque;
+  auto used = const_cdeque.used_segments();
+  EXPECT_EQ(used[0].size() + used[1].size(), const_cdeque.size());
+  static_assert(std::is_same_v<
+                decltype(used[0].data()),
+                std::size_t const*>);
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include <istream>
+#include <ostream>
+#include <ouroboros/cyclic_streambuf.hpp>
+
+TEST(CyclicStreambufTest, WriteRead) {
+  ouroboros::cyclic_deque<char> cdeque(32);
+  ouroboros::cyclic_streambuf buf(cdeque);
+  std::ostream os(&buf);
+  std::istream is(&buf);
+
+  os << "ouroboros " << 42 << ' ' << 1.5 << std::flush;
+  EXPECT_EQ(std::string(cdeque.begin(), cdeque.end()), "ouroboros 42 1.5");
+
+  std::string name;
+  int i;
+  double d;
+  is >> name >> i >> d;
+  EXPECT_EQ(name, "ouroboros");
+  EXPECT_EQ(i, 42);
+  EXPECT_EQ(d, 1.5);
+  buf.pubsync();
+  EXPECT_TRUE(cdeque.empty());
+}
+
+TEST(CyclicStreambufTest, Wrapped) {
+  ouroboros::cyclic_deque<char> cdeque(8);
+  ouroboros::cyclic_streambuf buf(cdeque);
+  std::ostream os(&buf);
+  std::istream is(&buf);
+
+  std::string s;
+  for (int i = 0; i < 10; ++i) {
+    // Single character writes go through the put area, which wraps around the
+    // end of the buffer.
+    os << 'a' << 'b' << 'c' << 'd' << 'e' << ' ';
+    is >> s;
+    EXPECT_EQ(s, "abcde");
+    is.get();
+  }
+  buf.pubsync();
+  EXPECT_TRUE(cdeque.empty());
+}
+
+TEST(CyclicStreambufTest, BulkAndLimits) {
+  ouroboros::cyclic_deque<char> cdeque(8);
+  ouroboros::cyclic_streambuf buf(cdeque);
+
+  EXPECT_EQ(buf.sputn("0123456789", 10), 8);
+  EXPECT_TRUE(cdeque.full());
+  EXPECT_EQ(buf.sputc('x'), std::char_traits<char>::eof());
+  EXPECT_EQ(buf.in_avail(), 8);
+
+  char out[16] = {};
+  EXPECT_EQ(buf.sgetn(out, 5), 5);
+  EXPECT_EQ(std::string(out, 5), "01234");
+  EXPECT_EQ(buf.sputn("89ab", 4), 4);
+  EXPECT_EQ(buf.sgetn(out, 16), 7);
+  EXPECT_EQ(std::string(out, 7), "56789ab");
+  EXPECT_EQ(buf.sgetc(), std::char_traits<char>::eof());
+  EXPECT_TRUE(cdeque.empty());
+}
+
+TEST(CyclicStreambufTest, CommitOnDestruction) {
+  ouroboros::cyclic_deque<char> cdeque(8);
+  cdeque.push_back('z');
+  {
+    ouroboros::cyclic_streambuf buf(cdeque);
+    EXPECT_EQ(buf.sbumpc(), 'z');
+    buf.sputc('y');
+  }
+  ASSERT_EQ(cdeque.size(), 1);
+  EXPECT_EQ(cdeque.front(), 'y');
+}
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include <ouroboros/disruptor.hpp>
+#include <thread>
+
+namespace {
+
+struct Event {
+  std::int64_t raw;
+  std::int64_t decoded;
+  std::int64_t enriched;
+};
+
+}  // namespace
+
+TEST(DisruptorTest, Gating) {
+  ouroboros::disruptor<Event> d(4);
+  auto& a = d.add_stage();
+  auto& b = d.add_stage({&a});
+  EXPECT_EQ(d.capacity(), 4);
+
+  auto last = d.try_claim(4);
+  EXPECT_EQ(last, 3);
+  for (std::int64_t s = 0; s <= last; ++s) {
+    d[s].raw = s;
+  }
+  // Nothing is visible before publishing.
+  EXPECT_EQ(a.available(), ouroboros::sequence::initial_value);
+  d.publish(last);
+  EXPECT_EQ(a.available(), 3);
+  // The ring is full until the last stage processed the events.
+  EXPECT_EQ(d.try_claim(), ouroboros::sequence::initial_value);
+  EXPECT_EQ(b.available(), ouroboros::sequence::initial_value);
+
+  auto decode = [](Event& e, std::int64_t) { e.decoded = e.raw * 2; };
+  EXPECT_EQ(a.process(decode), 4);
+  EXPECT_EQ(d.try_claim(), ouroboros::sequence::initial_value);
+  EXPECT_EQ(b.available(), 3);
+  auto check = [](Event& e, std::int64_t s) { EXPECT_EQ(e.decoded, s * 2); };
+  EXPECT_EQ(b.process(check), 4);
+  EXPECT_EQ(d.try_claim(2), 5);
+}
+
+TEST(DisruptorTest, Pipeline) {
+  constexpr std::int64_t count = 50000;
+  ouroboros::disruptor<Event> d(64);
+  auto& decode = d.add_stage();
+  auto& enrich = d.add_stage({&decode});
+  auto& persist = d.add_stage({&enrich});
+
+  auto run = [](auto& stage, auto f) {
+    return std::thread([&stage, f]() {
+      while (stage.processed() < count - 1) {
+        if (stage.process(f) == 0) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  };
+
+  std::int64_t sum = 0;
+  bool ordered = true;
+  std::thread t1 = run(decode, [](Event& e, std::int64_t) {
+    e.decoded = e.raw + 1;
+  });
+  std::thread t2 = run(enrich, [](Event& e, std::int64_t) {
+    e.enriched = e.decoded * 2;
+  });
+  std::thread t3 = run(persist, [&](Event& e, std::int64_t s) {
+    ordered = ordered && e.raw == s && e.enriched == (s + 1) * 2;
+    sum += e.enriched;
+  });
+
+  for (std::int64_t i = 0; i < count;) {
+    std::int64_t last = d.claim(std::min<std::int64_t>(8, count - i));
+    for (; i <= last; ++i) {
+      d[i].raw = i;
+    }
+    d.publish(last);
+  }
+  t1.join();
+  t2.join();
+  t3.join();
+
+  EXPECT_TRUE(ordered);
+  EXPECT_EQ(sum, count * (count + 1));
+}
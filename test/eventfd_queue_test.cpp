@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <ouroboros/eventfd_queue.hpp>
+#include <ouroboros/mpsc_cyclic_queue.hpp>
+#include <thread>
+#include <vector>
+
+namespace {
+
+bool IsReadable(int fd) {
+  pollfd pfd{fd, POLLIN, 0};
+  return ::poll(&pfd, 1, 0) == 1 && (pfd.revents & POLLIN) != 0;
+}
+
+// Return the counter of the eventfd without changing it.
+std::uint64_t Counter(int fd) {
+  std::uint64_t count = 0;
+  if (::read(fd, &count, sizeof(count)) == sizeof(count)) {
+    EXPECT_EQ(::write(fd, &count, sizeof(count)), sizeof(count));
+  }
+  return count;
+}
+
+}  // namespace
+
+TEST(EventfdQueueTest, Coalescing) {
+  ouroboros::eventfd_queue<ouroboros::mpsc_cyclic_queue<int>> queue(8);
+  EXPECT_GE(queue.fd(), 0);
+  EXPECT_FALSE(IsReadable(queue.fd()));
+
+  // Only the first push into the empty queue signals.
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_TRUE(queue.try_push(i));
+  }
+  EXPECT_TRUE(IsReadable(queue.fd()));
+  EXPECT_EQ(Counter(queue.fd()), 1);
+
+  // Draining part of the queue leaves the eventfd readable.
+  std::vector<int> popped;
+  auto f = [&popped](int v) { popped.push_back(v); };
+  EXPECT_EQ(queue.drain(f, 3), 3);
+  EXPECT_TRUE(IsReadable(queue.fd()));
+  EXPECT_EQ(queue.drain(f, 3), 2);
+  EXPECT_FALSE(IsReadable(queue.fd()));
+  EXPECT_EQ(popped, (std::vector<int>{0, 1, 2, 3, 4}));
+
+  // Re-armed.
+  EXPECT_EQ(queue.drain(f), 0);
+  EXPECT_FALSE(IsReadable(queue.fd()));
+  EXPECT_TRUE(queue.try_push(5));
+  EXPECT_TRUE(IsReadable(queue.fd()));
+  EXPECT_EQ(queue.drain(f), 1);
+  EXPECT_EQ(popped.back(), 5);
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(EventfdQueueTest, EpollLoop) {
+  constexpr int producers = 3;
+  constexpr int count = 20000;
+  ouroboros::eventfd_queue<ouroboros::mpsc_cyclic_queue<int>> queue(64);
+
+  int epfd = ::epoll_create1(EPOLL_CLOEXEC);
+  ASSERT_GE(epfd, 0);
+  epoll_event ev{};
+  ev.events = EPOLLIN;
+  ASSERT_EQ(::epoll_ctl(epfd, EPOLL_CTL_ADD, queue.fd(), &ev), 0);
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; ++p) {
+    threads.emplace_back([&queue]() {
+      for (int i = 1; i <= count; ++i) {
+        while (!queue.try_push(i)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  // The loop never misses a wakeup. A lost one would block forever.
+  std::int64_t sum = 0;
+  int received = 0;
+  while (received < producers * count) {
+    epoll_event out;
+    ASSERT_EQ(::epoll_wait(epfd, &out, 1, 10000), 1);
+    received += static_cast<int>(
+        queue.drain([&sum](int v) { sum += v; }, 32));
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  ::close(epfd);
+  EXPECT_EQ(sum, std::int64_t{producers} * count * (count + 1) / 2);
+}
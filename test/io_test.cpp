@@ -0,0 +1,231 @@
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <ouroboros/io.hpp>
+
+namespace {
+
+class Pipe {
+ public:
+  Pipe() {
+    if (::pipe(fds_) != 0) {
+      throw std::system_error(errno, std::generic_category(), "pipe");
+    }
+  }
+
+  ~Pipe() {
+    ::close(fds_[0]);
+    ::close(fds_[1]);
+  }
+
+  int read_end() const { return fds_[0]; }
+
+  int write_end() const { return fds_[1]; }
+
+  void CloseWriteEnd() {
+    ::close(fds_[1]);
+    fds_[1] = -1;
+  }
+
+  void SetNonBlocking() {
+    for (int fd : fds_) {
+      ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+  }
+
+ private:
+  int fds_[2];
+};
+
+}  // namespace
+
+TEST(IoTest, RoundTripWrapped) {
+  Pipe p;
+  ouroboros::cyclic_deque<char> out(8);
+  ouroboros::cyclic_deque<char> in(8);
+  // Make both rings wrap around the end of their buffers.
+  out.resize(5);
+  out.pop_front(5);
+  in.resize(6);
+  in.pop_front(6);
+
+  std::string message = "ouroboro";
+  out.append_range(message);
+  auto w = ouroboros::io::drain_to_fd(out, p.write_end());
+  EXPECT_EQ(w.count, message.size());
+  EXPECT_EQ(w.status, ouroboros::io::io_status::ok);
+  EXPECT_TRUE(out.empty());
+
+  auto r = ouroboros::io::fill_from_fd(in, p.read_end());
+  EXPECT_EQ(r.count, message.size());
+  EXPECT_EQ(r.status, ouroboros::io::io_status::ok);
+  EXPECT_EQ(std::string(in.begin(), in.end()), message);
+}
+
+TEST(IoTest, PartialFill) {
+  Pipe p;
+  ouroboros::cyclic_deque<char> in(4);
+  std::string message = "serpent";
+  ASSERT_EQ(
+      ::write(p.write_end(), message.data(), message.size()),
+      static_cast<ssize_t>(message.size()));
+
+  auto r = ouroboros::io::fill_from_fd(in, p.read_end());
+  EXPECT_EQ(r.count, 4);
+  EXPECT_TRUE(in.full());
+  // A full ring doesn't issue a system call.
+  EXPECT_EQ(ouroboros::io::fill_from_fd(in, p.read_end()).count, 0);
+  in.pop_front(2);
+  r = ouroboros::io::fill_from_fd(in, p.read_end());
+  EXPECT_EQ(r.count, 2);
+  EXPECT_EQ(std::string(in.begin(), in.end()), "rpen");
+}
+
+TEST(IoTest, WouldBlockAndEndOfFile) {
+  Pipe p;
+  p.SetNonBlocking();
+  ouroboros::cyclic_deque<char> in(4);
+  auto r = ouroboros::io::fill_from_fd(in, p.read_end());
+  EXPECT_EQ(r.count, 0);
+  EXPECT_EQ(r.status, ouroboros::io::io_status::would_block);
+
+  // Reading from a pipe without writers results in the end of the file.
+  int fds[2];
+  ASSERT_EQ(::pipe(fds), 0);
+  ::close(fds[1]);
+  r = ouroboros::io::fill_from_fd(in, fds[0]);
+  ::close(fds[0]);
+  EXPECT_EQ(r.count, 0);
+  EXPECT_EQ(r.status, ouroboros::io::io_status::end_of_file);
+}
+
+TEST(IoTest, TriviallyCopyable) {
+  Pipe p;
+  ouroboros::cyclic_deque<std::uint32_t> out(16);
+  ouroboros::cyclic_deque<std::uint32_t> in(16);
+  out.resize(10);
+  out.pop_front(10);
+  std::vector<std::uint32_t> values(12);
+  std::iota(values.begin(), values.end(), 100);
+  out.append_range(values);
+
+  ouroboros::io::partial_element written;
+  ouroboros::io::partial_element read;
+  EXPECT_EQ(ouroboros::io::drain_to_fd(out, p.write_end(), written).count, 12);
+  EXPECT_EQ(written.bytes, 0);
+  EXPECT_EQ(ouroboros::io::fill_from_fd(in, p.read_end(), read).count, 12);
+  EXPECT_EQ(read.bytes, 0);
+  EXPECT_TRUE(std::equal(in.begin(), in.end(), values.begin()));
+}
+
+TEST(IoTest, PartialElement) {
+  Pipe p;
+  p.SetNonBlocking();
+  ouroboros::cyclic_deque<std::uint32_t> in(4);
+  // Make the partial element wrap around the end of the buffer.
+  in.resize(3);
+  in.pop_front(3);
+  std::uint32_t values[] = {0x01020304, 0x05060708};
+  auto const* bytes = reinterpret_cast<char const*>(values);
+
+  ouroboros::io::partial_element partial;
+  ASSERT_EQ(::write(p.write_end(), bytes, 6), 6);
+  auto r = ouroboros::io::fill_from_fd(in, p.read_end(), partial);
+  EXPECT_EQ(r.count, 1);
+  EXPECT_EQ(r.status, ouroboros::io::io_status::ok);
+  EXPECT_EQ(partial.bytes, 2);
+
+  // Returns instead of waiting for the rest of the element.
+  r = ouroboros::io::fill_from_fd(in, p.read_end(), partial);
+  EXPECT_EQ(r.count, 0);
+  EXPECT_EQ(r.status, ouroboros::io::io_status::would_block);
+  EXPECT_EQ(partial.bytes, 2);
+
+  ASSERT_EQ(::write(p.write_end(), bytes + 6, 2), 2);
+  r = ouroboros::io::fill_from_fd(in, p.read_end(), partial);
+  EXPECT_EQ(r.count, 1);
+  EXPECT_EQ(partial.bytes, 0);
+  ASSERT_EQ(in.size(), 2);
+  EXPECT_EQ(in[0], values[0]);
+  EXPECT_EQ(in[1], values[1]);
+}
+
+TEST(IoTest, PartialWrite) {
+  Pipe p;
+  ouroboros::cyclic_deque<std::uint32_t> out(4);
+  out.push_back(0x01020304);
+  out.push_back(0x05060708);
+  ouroboros::cyclic_deque<std::uint32_t> in(4);
+
+  // Continues after the bytes of the front element that were written.
+  ouroboros::io::partial_element written{3};
+  auto w = ouroboros::io::drain_to_fd(out, p.write_end(), written);
+  EXPECT_EQ(w.count, 2);
+  EXPECT_EQ(written.bytes, 0);
+  EXPECT_TRUE(out.empty());
+
+  char bytes[5];
+  ASSERT_EQ(::read(p.read_end(), bytes, sizeof(bytes)), 5);
+  std::uint32_t second;
+  std::memcpy(&second, bytes + 1, sizeof(second));
+  EXPECT_EQ(second, 0x05060708u);
+}
+
+TEST(IoTest, Truncated) {
+  Pipe p;
+  ouroboros::cyclic_deque<std::uint32_t> in(4);
+  std::uint32_t value = 7;
+  ASSERT_EQ(::write(p.write_end(), &value, 2), 2);
+  p.CloseWriteEnd();
+
+  ouroboros::io::partial_element partial;
+  auto r = ouroboros::io::fill_from_fd(in, p.read_end(), partial);
+  EXPECT_EQ(r.count, 0);
+  EXPECT_EQ(r.status, ouroboros::io::io_status::ok);
+  EXPECT_EQ(partial.bytes, 2);
+  r = ouroboros::io::fill_from_fd(in, p.read_end(), partial);
+  EXPECT_EQ(r.count, 0);
+  EXPECT_EQ(r.status, ouroboros::io::io_status::truncated);
+  EXPECT_EQ(partial.bytes, 0);
+  r = ouroboros::io::fill_from_fd(in, p.read_end(), partial);
+  EXPECT_EQ(r.status, ouroboros::io::io_status::end_of_file);
+  EXPECT_TRUE(in.empty());
+}
+
+TEST(IoTest, BadDescriptor) {
+  ouroboros::cyclic_deque<char> in(4);
+  EXPECT_THROW(ouroboros::io::fill_from_fd(in, -1), std::system_error);
+}
+
+TEST(IoTest, SnapshotFile) {
+  std::vector<std::uint32_t> values(12);
+  std::iota(values.begin(), values.end(), 7);
+  ouroboros::cyclic_deque<std::uint32_t> ring(16);
+  ring.resize(10);
+  ring.pop_front(10);
+  ring.append_range(values);
+
+  FILE* file = std::tmpfile();
+  ASSERT_NE(file, nullptr);
+  int fd = ::fileno(file);
+  ouroboros::serialize(ring, ouroboros::io::fd_writer(fd));
+
+  auto mapped = ouroboros::io::deserialize_mapped<std::uint32_t>(fd);
+  EXPECT_EQ(mapped.capacity(), ring.capacity());
+  EXPECT_TRUE(std::equal(mapped.begin(), mapped.end(), values.begin()));
+
+  ASSERT_EQ(::lseek(fd, 0, SEEK_SET), 0);
+  auto streamed = ouroboros::deserialize<std::uint32_t>(
+      ouroboros::io::fd_reader(fd));
+  EXPECT_EQ(streamed.size(), values.size());
+  EXPECT_TRUE(std::equal(streamed.begin(), streamed.end(), values.begin()));
+  EXPECT_THROW(
+      ouroboros::deserialize<std::uint32_t>(ouroboros::io::fd_reader(fd)),
+      std::runtime_error);
+  std::fclose(file);
+}
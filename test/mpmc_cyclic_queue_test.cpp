@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <ouroboros/mpmc_cyclic_queue.hpp>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(MpmcCyclicQueueTest, PushPop) {
+  // The capacity is rounded up to a power of two.
+  ouroboros::mpmc_cyclic_queue<std::size_t> queue(3);
+  EXPECT_EQ(queue.capacity(), 4);
+
+  std::size_t v;
+  EXPECT_FALSE(queue.try_pop(v));
+  for (std::size_t lap = 0; lap < 5; ++lap) {
+    for (std::size_t i = 0; i < 4; ++i) {
+      EXPECT_TRUE(queue.try_push(lap + i));
+    }
+    EXPECT_FALSE(queue.try_push(0));
+    EXPECT_EQ(queue.size(), 4);
+    for (std::size_t i = 0; i < 4; ++i) {
+      EXPECT_TRUE(queue.try_pop(v));
+      EXPECT_EQ(v, lap + i);
+    }
+    EXPECT_FALSE(queue.try_pop(v));
+    EXPECT_TRUE(queue.empty());
+  }
+}
+
+TEST(MpmcCyclicQueueTest, ProducersConsumers) {
+  constexpr std::size_t producers = 4;
+  constexpr std::size_t consumers = 4;
+  constexpr std::size_t count = 20000;
+  ouroboros::mpmc_cyclic_queue<std::size_t> queue(32);
+  std::atomic<std::size_t> consumed{0};
+  std::atomic<std::size_t> sum{0};
+  // Every consumer should see the elements of each producer in order.
+  std::atomic<bool> ordered{true};
+
+  std::vector<std::thread> threads;
+  for (std::size_t p = 0; p < producers; ++p) {
+    threads.emplace_back([&queue, p]() {
+      for (std::size_t i = 0; i < count; ++i) {
+        while (!queue.try_push(p * count + i)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (std::size_t c = 0; c < consumers; ++c) {
+    threads.emplace_back([&]() {
+      std::vector<std::size_t> last(producers, 0);
+      std::size_t v;
+      while (consumed.load() < producers * count) {
+        if (queue.try_pop(v)) {
+          std::size_t p = v / count;
+          if (v % count + 1 <= last[p]) {
+            ordered = false;
+          }
+          last[p] = v % count + 1;
+          sum += v;
+          ++consumed;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  std::size_t n = producers * count;
+  EXPECT_EQ(consumed.load(), n);
+  EXPECT_EQ(sum.load(), n * (n - 1) / 2);
+  EXPECT_TRUE(ordered.load());
+  EXPECT_TRUE(queue.empty());
+}
+
+namespace {
+
+// Throws when converted to a std::string, if so requested.
+struct throwing {
+  operator std::string() const {
+    if (fail) {
+      throw std::runtime_error("conversion");
+    }
+    return "ok";
+  }
+
+  bool fail;
+};
+
+}  // namespace
+
+TEST(MpmcCyclicQueueTest, Exceptions) {
+  // An element that throws on assignment doesn't claim a slot.
+  ouroboros::mpmc_cyclic_queue<std::string> queue(2);
+  EXPECT_THROW(queue.try_push(throwing{true}), std::runtime_error);
+  EXPECT_TRUE(queue.empty());
+  EXPECT_TRUE(queue.try_push(throwing{false}));
+  EXPECT_TRUE(queue.try_push(std::string("a")));
+  EXPECT_FALSE(queue.try_push(std::string("b")));
+
+  std::string v;
+  EXPECT_TRUE(queue.try_pop(v));
+  EXPECT_EQ(v, "ok");
+  EXPECT_TRUE(queue.try_pop(v));
+  EXPECT_EQ(v, "a");
+  EXPECT_FALSE(queue.try_pop(v));
+}
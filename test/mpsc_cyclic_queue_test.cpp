@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <ouroboros/mpsc_cyclic_queue.hpp>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(MpscCyclicQueueTest, ClaimPublishConsume) {
+  ouroboros::mpsc_cyclic_queue<std::size_t> queue(8);
+  EXPECT_EQ(queue.capacity(), 8);
+
+  auto a = queue.claim(3);
+  auto b = queue.claim(3);
+  ASSERT_EQ(a.size(), 3);
+  ASSERT_EQ(b.size(), 3);
+  for (std::size_t i = 0; i < 3; ++i) {
+    a[i] = i;
+    b[i] = i + 3;
+  }
+  // Publishing out of order keeps the elements of b invisible until a is
+  // published.
+  queue.publish(b);
+  EXPECT_EQ(queue.readable_segments()[0].size(), 0);
+  queue.publish(a);
+  EXPECT_EQ(queue.readable_segments()[0].size(), 6);
+  EXPECT_TRUE(queue.try_claim(3).empty());
+
+  std::vector<std::size_t> out;
+  auto append = [&out](auto const& s) {
+    out.insert(out.end(), s.begin(), s.end());
+  };
+  EXPECT_EQ(queue.consume(append), 6);
+
+  // This claim wraps around the end of the buffer.
+  auto c = queue.try_claim(5);
+  ASSERT_EQ(c.size(), 5);
+  EXPECT_EQ(c.segments()[0].size(), 2);
+  EXPECT_EQ(c.segments()[1].size(), 3);
+  for (std::size_t i = 0; i < 5; ++i) {
+    c[i] = i + 6;
+  }
+  queue.publish(c);
+  EXPECT_TRUE(queue.try_push(11));
+  auto segments = queue.readable_segments();
+  EXPECT_EQ(segments[0].size(), 2);
+  EXPECT_EQ(segments[1].size(), 4);
+  EXPECT_EQ(queue.consume(append), 6);
+
+  ASSERT_EQ(out.size(), 12);
+  for (std::size_t i = 0; i < out.size(); ++i) {
+    EXPECT_EQ(out[i], i);
+  }
+  std::size_t v;
+  EXPECT_FALSE(queue.try_pop(v));
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(MpscCyclicQueueTest, Producers) {
+  constexpr std::size_t producers = 4;
+  constexpr std::size_t batches = 2000;
+  constexpr std::size_t batch_size = 5;
+  ouroboros::mpsc_cyclic_queue<std::size_t> queue(64);
+
+  std::vector<std::thread> threads;
+  for (std::size_t p = 0; p < producers; ++p) {
+    threads.emplace_back([&queue, p]() {
+      for (std::size_t b = 0; b < batches; ++b) {
+        auto c = queue.claim(batch_size);
+        for (std::size_t i = 0; i < batch_size; ++i) {
+          c[i] = (p * batches + b) * batch_size + i;
+        }
+        queue.publish(c);
+      }
+    });
+  }
+
+  // Batches are contiguous and the batches of a producer arrive in order.
+  std::size_t total = producers * batches * batch_size;
+  std::vector<std::size_t> next(producers, 0);
+  std::vector<std::size_t> received;
+  std::size_t consumed = 0;
+  while (consumed < total) {
+    std::size_t v;
+    if (queue.try_pop(v)) {
+      received.push_back(v);
+      ++consumed;
+    }
+    consumed += queue.consume([&](auto const& s) {
+      received.insert(received.end(), s.begin(), s.end());
+    });
+    if (consumed < total) {
+      std::this_thread::yield();
+    }
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  ASSERT_EQ(received.size(), total);
+  for (std::size_t i = 0; i < total; i += batch_size) {
+    std::size_t batch = received[i] / batch_size;
+    std::size_t p = batch / batches;
+    EXPECT_EQ(batch % batches, next[p]++);
+    for (std::size_t j = 0; j < batch_size; ++j) {
+      EXPECT_EQ(received[i + j], batch * batch_size + j);
+    }
+  }
+}
+
+namespace {
+
+// Throws when converted to a std::string, if so requested.
+struct throwing {
+  operator std::string() const {
+    if (fail) {
+      throw std::runtime_error("conversion");
+    }
+    return "ok";
+  }
+
+  bool fail;
+};
+
+}  // namespace
+
+TEST(MpscCyclicQueueTest, Exceptions) {
+  // An element that throws on assignment doesn't claim a slot.
+  ouroboros::mpsc_cyclic_queue<std::string> queue(2);
+  EXPECT_THROW(queue.try_push(throwing{true}), std::runtime_error);
+  EXPECT_TRUE(queue.empty());
+  EXPECT_TRUE(queue.try_push(throwing{false}));
+  EXPECT_TRUE(queue.try_push(std::string("a")));
+  EXPECT_FALSE(queue.try_push(std::string("b")));
+
+  std::string v;
+  EXPECT_TRUE(queue.try_pop(v));
+  EXPECT_EQ(v, "ok");
+  EXPECT_TRUE(queue.try_pop(v));
+  EXPECT_EQ(v, "a");
+  EXPECT_FALSE(queue.try_pop(v));
+}
@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <ouroboros/object_pool.hpp>
+#include <thread>
+#include <vector>
+
+TEST(ObjectPoolTest, AcquireRelease) {
+  ouroboros::object_pool<std::vector<char>> pool(3, 0, std::vector<char>(16));
+  EXPECT_EQ(pool.capacity(), 3);
+
+  std::vector<char>* a = pool.acquire();
+  std::vector<char>* b = pool.acquire();
+  std::vector<char>* c = pool.acquire();
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(c, nullptr);
+  EXPECT_EQ(a->size(), 16);
+  EXPECT_TRUE(pool.owns(b));
+  EXPECT_EQ(pool.acquire(), nullptr);
+
+  auto s = pool.stats();
+  EXPECT_EQ(s.capacity, 3);
+  EXPECT_EQ(s.in_use, 3);
+  EXPECT_EQ(s.acquired, 3);
+  EXPECT_EQ(s.exhausted, 1);
+
+  pool.release(b);
+  {
+    auto u = pool.acquire_unique();
+    EXPECT_EQ(u.get(), b);
+    EXPECT_EQ(pool.stats().in_use, 3);
+  }
+  pool.release(a);
+  pool.release(c);
+  s = pool.stats();
+  EXPECT_EQ(s.in_use, 0);
+  EXPECT_EQ(s.acquired, 4);
+  EXPECT_EQ(s.released, 4);
+}
+
+TEST(ObjectPoolTest, Magazine) {
+  ouroboros::object_pool<int> pool(8, 4);
+  EXPECT_EQ(pool.magazine_size(), 4);
+
+  // The first acquire moves half a magazine into the cache of this thread.
+  int* a = pool.acquire();
+  ASSERT_NE(a, nullptr);
+  std::thread([&pool]() {
+    std::vector<int*> taken;
+    while (int* p = pool.acquire()) {
+      taken.push_back(p);
+    }
+    EXPECT_EQ(taken.size(), 5);
+    for (int* p : taken) {
+      pool.release(p);
+    }
+  }).join();
+
+  // The magazine of the other thread was returned when it exited.
+  std::vector<int*> taken{a};
+  while (int* p = pool.acquire()) {
+    taken.push_back(p);
+  }
+  EXPECT_EQ(taken.size(), 8);
+  for (int* p : taken) {
+    pool.release(p);
+  }
+  auto s = pool.stats();
+  EXPECT_EQ(s.in_use, 0);
+  EXPECT_EQ(s.exhausted, 2);
+}
+
+TEST(ObjectPoolTest, ManyPools) {
+  // Pools reuse the thread-local slots of destroyed pools, but never their
+  // magazines.
+  for (int i = 0; i < 100; ++i) {
+    ouroboros::object_pool<int> pool(4, 2, i);
+    int* p = pool.acquire();
+    ASSERT_TRUE(pool.owns(p));
+    EXPECT_EQ(*p, i);
+    pool.release(p);
+    EXPECT_EQ(pool.stats().acquired, 1);
+  }
+}
+
+TEST(ObjectPoolTest, ExitedThreads) {
+  // The counters of exited threads are kept after their records are dropped.
+  ouroboros::object_pool<int> pool(2, 2);
+  for (int i = 0; i < 1000; ++i) {
+    std::thread([&pool]() {
+      int* p = pool.acquire();
+      ASSERT_NE(p, nullptr);
+      int* q = pool.acquire();
+      EXPECT_EQ(pool.acquire(), nullptr);
+      pool.release(p);
+      pool.release(q);
+    }).join();
+  }
+  int* p = pool.acquire();
+  auto s = pool.stats();
+  EXPECT_EQ(s.acquired, 2001);
+  EXPECT_EQ(s.released, 2000);
+  EXPECT_EQ(s.exhausted, 1000);
+  EXPECT_EQ(s.in_use, 1);
+  pool.release(p);
+}
+
+TEST(ObjectPoolTest, Threads) {
+  constexpr int threads = 4;
+  constexpr int count = 20000;
+  ouroboros::object_pool<int> pool(threads * 16, 8, 0);
+  std::atomic<bool> exclusive{true};
+
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; ++t) {
+    workers.emplace_back([&]() {
+      std::vector<int*> held;
+      for (int i = 0; i < count; ++i) {
+        if (int* p = pool.acquire()) {
+          // No other thread holds the object.
+          if (++*p != 1) {
+            exclusive = false;
+          }
+          held.push_back(p);
+        }
+        if (held.size() > 4 || (i % 3 == 0 && !held.empty())) {
+          --*held.back();
+          pool.release(held.back());
+          held.pop_back();
+        }
+      }
+      for (int* p : held) {
+        --*p;
+        pool.release(p);
+      }
+    });
+  }
+  for (auto& w : workers) {
+    w.join();
+  }
+  EXPECT_TRUE(exclusive.load());
+  auto s = pool.stats();
+  EXPECT_EQ(s.in_use, 0);
+  EXPECT_EQ(s.acquired, s.released);
+}
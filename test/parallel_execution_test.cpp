@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+// Enables the overloads of ouroboros::parallel that take a standard execution
+// policy. Only this translation unit tests them.
+#if __has_include(<execution>)
+#define OUROBOROS_PARALLEL_STD_EXECUTION
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <ouroboros/cyclic_deque.hpp>
+#include <ouroboros/parallel.hpp>
+#include <vector>
+
+#include "wrapped_ring.hpp"
+
+TEST(ParallelExecutionTest, ForEachTransform) {
+#if defined(__cpp_lib_execution)
+  auto r = MakeWrappedRing(10000);
+  ouroboros::parallel::for_each(
+      std::execution::par, r, [](std::uint32_t& v) { v *= 2; });
+  for (std::uint32_t i = 0; i < r.size(); ++i) {
+    ASSERT_EQ(r[i], 2 * i);
+  }
+
+  // Into another ring with a different layout.
+  ouroboros::cyclic_deque<std::uint32_t> out(r.size(), r.size());
+  out.pop_front(100);
+  out.resize(r.size());
+  ouroboros::parallel::transform(
+      std::execution::par, r, out.begin(),
+      [](std::uint32_t v) { return v + 1; });
+  for (std::uint32_t i = 0; i < r.size(); ++i) {
+    ASSERT_EQ(out[i], 2 * i + 1);
+  }
+#else
+  GTEST_SKIP() << "The standard library lacks execution policies.";
+#endif
+}
+
+TEST(ParallelExecutionTest, Sort) {
+#if defined(__cpp_lib_execution)
+  auto r = MakeWrappedRing(10000);
+  for (auto& v : r) {
+    v = (v * 2654435761u) % 1000;
+  }
+  std::vector<std::uint32_t> expected(r.begin(), r.end());
+  std::sort(expected.begin(), expected.end(), std::greater<>());
+  ouroboros::parallel::sort(std::execution::par, r, std::greater<>());
+  EXPECT_TRUE(std::equal(r.begin(), r.end(), expected.begin()));
+#else
+  GTEST_SKIP() << "The standard library lacks execution policies.";
+#endif
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <ouroboros/cyclic_deque.hpp>
+#include <ouroboros/parallel.hpp>
+#include <string>
+#include <vector>
+
+#include "wrapped_ring.hpp"
+
+TEST(ParallelTest, Chunks) {
+  auto r = MakeWrappedRing(10000);
+  auto segments = r.used_segments();
+  auto chunks = ouroboros::internal::make_chunks(segments, 1024);
+  std::size_t index = 0;
+  for (auto const& c : chunks) {
+    EXPECT_EQ(c.index, index);
+    EXPECT_EQ(c.first, &r[c.index]);
+    EXPECT_LE(c.size, 256);
+    index += c.size;
+    // Chunk boundaries that are not at the end of a segment are aligned.
+    if (c.first + c.size != segments[0].data() + segments[0].size() &&
+        c.first + c.size != segments[1].data() + segments[1].size()) {
+      EXPECT_EQ(reinterpret_cast<std::uintptr_t>(c.first + c.size) % 64, 0);
+    }
+  }
+  EXPECT_EQ(index, r.size());
+}
+
+TEST(ParallelTest, ForEachTransform) {
+  ouroboros::thread_pool pool(3);
+  auto r = MakeWrappedRing(10000);
+  ouroboros::parallel::for_each(
+      pool, r, [](std::uint32_t& v) { v *= 2; }, 256);
+  for (std::uint32_t i = 0; i < r.size(); ++i) {
+    ASSERT_EQ(r[i], 2 * i);
+  }
+
+  // Into another ring with a different layout.
+  ouroboros::cyclic_deque<std::uint32_t> out(r.size(), r.size());
+  out.pop_front(100);
+  out.resize(r.size());
+  ouroboros::parallel::transform(
+      pool, r, out.begin(), [](std::uint32_t v) { return v + 1; }, 256);
+  for (std::uint32_t i = 0; i < r.size(); ++i) {
+    ASSERT_EQ(out[i], 2 * i + 1);
+  }
+}
+
+TEST(ParallelTest, Reduce) {
+  ouroboros::thread_pool pool(3);
+  auto const r = MakeWrappedRing(10000);
+  EXPECT_EQ(
+      ouroboros::parallel::reduce(pool, r, std::uint64_t{0}),
+      std::accumulate(r.begin(), r.end(), std::uint64_t{0}));
+
+  // String concatenation is associative but not commutative.
+  std::string expected;
+  for (auto v : r) {
+    expected += static_cast<char>('a' + v % 26);
+  }
+  std::string result = ouroboros::parallel::transform_reduce(
+      pool, r, std::string(">"), std::plus<>(),
+      [](std::uint32_t v) { return std::string(1, 'a' + v % 26); }, 256);
+  EXPECT_EQ(result, ">" + expected);
+
+  ouroboros::cyclic_deque<int> empty(4);
+  EXPECT_EQ(ouroboros::parallel::reduce(pool, empty, 7), 7);
+}
+
+TEST(ParallelTest, Sort) {
+  ouroboros::thread_pool pool(3);
+  auto r = MakeWrappedRing(10000);
+  for (auto& v : r) {
+    v = (v * 2654435761u) % 1000;
+  }
+  std::vector<std::uint32_t> expected(r.begin(), r.end());
+  std::sort(expected.begin(), expected.end(), std::greater<>());
+  ouroboros::parallel::sort(pool, r, std::greater<>(), 256);
+  EXPECT_TRUE(std::equal(r.begin(), r.end(), expected.begin()));
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <ouroboros/serialization.hpp>
+
+namespace {
+
+struct Sample {
+  std::uint32_t id;
+  float value;
+};
+
+ouroboros::cyclic_deque<Sample> MakeWrappedRing() {
+  ouroboros::cyclic_deque<Sample> ring(8);
+  ring.resize(6);
+  ring.pop_front(6);
+  for (std::uint32_t i = 0; i < 5; ++i) {
+    ring.push_back({i, static_cast<float>(i) * 0.5f});
+  }
+  return ring;
+}
+
+}  // namespace
+
+TEST(SerializationTest, RoundTrip) {
+  auto ring = MakeWrappedRing();
+  std::vector<unsigned char> bytes;
+  std::size_t calls = 0;
+  ouroboros::serialize(ring, [&](void const* data, std::size_t n) {
+    auto p = static_cast<unsigned char const*>(data);
+    bytes.insert(bytes.end(), p, p + n);
+    ++calls;
+  });
+  // Header plus two contiguous blocks.
+  EXPECT_EQ(calls, 3);
+  EXPECT_EQ(
+      bytes.size(), sizeof(ouroboros::snapshot_header) + 5 * sizeof(Sample));
+
+  auto copy = ouroboros::deserialize<Sample>(bytes.data(), bytes.size());
+  EXPECT_EQ(copy.capacity(), ring.capacity());
+  ASSERT_EQ(copy.size(), ring.size());
+  for (std::size_t i = 0; i < ring.size(); ++i) {
+    EXPECT_EQ(copy[i].id, ring[i].id);
+    EXPECT_EQ(copy[i].value, ring[i].value);
+  }
+
+  std::size_t offset = 0;
+  auto streamed =
+      ouroboros::deserialize<Sample>([&](void* data, std::size_t n) {
+        std::memcpy(data, bytes.data() + offset, n);
+        offset += n;
+      });
+  EXPECT_EQ(offset, bytes.size());
+  EXPECT_EQ(streamed.size(), ring.size());
+  EXPECT_EQ(streamed.back().id, 4);
+}
+
+TEST(SerializationTest, Empty) {
+  ouroboros::cyclic_deque<int> ring(3);
+  std::vector<unsigned char> bytes;
+  ouroboros::serialize(ring, [&](void const* data, std::size_t n) {
+    auto p = static_cast<unsigned char const*>(data);
+    bytes.insert(bytes.end(), p, p + n);
+  });
+  auto copy = ouroboros::deserialize<int>(bytes.data(), bytes.size());
+  EXPECT_EQ(copy.capacity(), 3);
+  EXPECT_TRUE(copy.empty());
+}
+
+TEST(SerializationTest, Invalid) {
+  std::vector<int> v(4);
+  std::iota(v.begin(), v.end(), 0);
+  ouroboros::cyclic_deque<int> ring(v.begin(), v.end());
+  std::vector<unsigned char> bytes;
+  ouroboros::serialize(ring, [&](void const* data, std::size_t n) {
+    auto p = static_cast<unsigned char const*>(data);
+    bytes.insert(bytes.end(), p, p + n);
+  });
+
+  // Element size mismatch.
+  EXPECT_THROW(
+      ouroboros::deserialize<std::uint64_t>(bytes.data(), bytes.size()),
+      std::runtime_error);
+  // Truncated contents.
+  EXPECT_THROW(
+      ouroboros::deserialize<int>(bytes.data(), bytes.size() - 1),
+      std::runtime_error);
+  // A size that the contents don't hold is rejected before allocating.
+  ouroboros::snapshot_header header;
+  std::memcpy(&header, bytes.data(), sizeof(header));
+  auto corrupt = bytes;
+  header.capacity = std::uint64_t(1) << 40;
+  header.size = header.capacity;
+  std::memcpy(corrupt.data(), &header, sizeof(header));
+  EXPECT_THROW(
+      ouroboros::deserialize<int>(corrupt.data(), corrupt.size()),
+      std::runtime_error);
+  // A capacity that overflows the number of bytes.
+  header.capacity = ~std::uint64_t(0);
+  header.size = 0;
+  std::memcpy(corrupt.data(), &header, sizeof(header));
+  EXPECT_THROW(
+      ouroboros::deserialize<int>(corrupt.data(), corrupt.size()),
+      std::runtime_error);
+  // Corrupt magic number.
+  bytes[0] ^= 0xff;
+  EXPECT_THROW(
+      ouroboros::deserialize<int>(bytes.data(), bytes.size()),
+      std::runtime_error);
+}
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <ouroboros/sharded_ring.hpp>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+TEST(ShardedRingTest, Consume) {
+  ouroboros::sharded_ring<int> ring(4, 2);
+  EXPECT_EQ(ring.max_shards(), 2);
+  EXPECT_EQ(ring.shard_capacity(), 4);
+  EXPECT_EQ(ring.consume([](int) { FAIL(); }), 0);
+
+  // The calling thread gets a shard of its own.
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(ring.try_push(i));
+  }
+  EXPECT_FALSE(ring.try_push(4));
+  EXPECT_EQ(ring.shards(), 1);
+
+  std::thread([&ring]() { EXPECT_TRUE(ring.try_push(10)); }).join();
+  EXPECT_EQ(ring.shards(), 2);
+  std::thread([&ring]() {
+    EXPECT_THROW(ring.try_push(20), std::length_error);
+  }).join();
+
+  std::vector<int> out;
+  auto f = [&out](int v) { out.push_back(v); };
+  EXPECT_EQ(ring.consume(f, 2), 3);
+  EXPECT_EQ(out, (std::vector<int>{0, 1, 10}));
+  out.clear();
+  EXPECT_EQ(ring.consume(f), 2);
+  EXPECT_EQ(out, (std::vector<int>{2, 3}));
+}
+
+TEST(ShardedRingTest, ReuseShards) {
+  ouroboros::sharded_ring<int> ring(16, 4);
+  std::vector<int> out;
+  auto f = [&out](int v) { out.push_back(v); };
+  for (int i = 0; i < 6; ++i) {
+    std::thread([&ring, i]() { EXPECT_TRUE(ring.try_push(i)); }).join();
+    EXPECT_EQ(ring.consume(f), 1);
+  }
+  EXPECT_EQ(out, (std::vector<int>{0, 1, 2, 3, 4, 5}));
+  EXPECT_EQ(ring.shards(), 1);
+
+  // A retired shard is only reused once it is drained.
+  for (int i = 0; i < 4; ++i) {
+    std::thread([&ring, i]() { EXPECT_TRUE(ring.try_push(i)); }).join();
+  }
+  EXPECT_EQ(ring.shards(), 4);
+  std::thread([&ring]() {
+    EXPECT_THROW(ring.try_push(4), std::length_error);
+  }).join();
+  out.clear();
+  EXPECT_EQ(ring.consume_ordered([](int v) { return v; }, f), 4);
+  EXPECT_EQ(out, (std::vector<int>{0, 1, 2, 3}));
+  std::thread([&ring]() { EXPECT_TRUE(ring.try_push(4)); }).join();
+  EXPECT_EQ(ring.shards(), 4);
+}
+
+TEST(ShardedRingTest, ManyRings) {
+  // Rings reuse the thread-local slots of destroyed rings, but never their
+  // shards.
+  for (int i = 0; i < 100; ++i) {
+    ouroboros::sharded_ring<int> a(2, 1);
+    ouroboros::sharded_ring<int> b(2, 1);
+    EXPECT_TRUE(b.try_push(i));
+    EXPECT_TRUE(a.try_push(-i));
+    EXPECT_EQ(a.shards(), 1);
+    EXPECT_EQ(b.shards(), 1);
+    std::vector<int> out;
+    b.consume([&out](int v) { out.push_back(v); });
+    a.consume([&out](int v) { out.push_back(v); });
+    EXPECT_EQ(out, (std::vector<int>{i, -i}));
+  }
+}
+
+TEST(ShardedRingTest, ConsumeOrdered) {
+  using stamped = std::pair<std::uint64_t, int>;
+  ouroboros::sharded_ring<stamped> ring(64, 4);
+  // Each producer pushes increasing timestamps that interleave with those of
+  // the other producers.
+  std::vector<std::thread> threads;
+  for (int p = 0; p < 3; ++p) {
+    threads.emplace_back([&ring, p]() {
+      for (std::uint64_t t = p; t < 60; t += 3) {
+        EXPECT_TRUE(ring.try_push(stamped{t, p}));
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  std::vector<std::uint64_t> out;
+  auto key = [](stamped const& s) { return s.first; };
+  auto f = [&out](stamped const& s) { out.push_back(s.first); };
+  EXPECT_EQ(ring.consume_ordered(key, f, 10), 10);
+  // Elements held back by the first merge are returned by the next one.
+  EXPECT_EQ(ring.consume_ordered(key, f), 50);
+  ASSERT_EQ(out.size(), 60);
+  for (std::uint64_t i = 0; i < 60; ++i) {
+    EXPECT_EQ(out[i], i);
+  }
+}
+
+TEST(ShardedRingTest, Producers) {
+  constexpr std::size_t producers = 4;
+  constexpr std::size_t count = 20000;
+  ouroboros::sharded_ring<std::size_t> ring(64, producers);
+  std::atomic<std::size_t> done{0};
+
+  std::vector<std::thread> threads;
+  for (std::size_t p = 0; p < producers; ++p) {
+    threads.emplace_back([&]() {
+      for (std::size_t i = 1; i <= count; ++i) {
+        while (!ring.try_push(i)) {
+          std::this_thread::yield();
+        }
+      }
+      ++done;
+    });
+  }
+
+  std::size_t consumed = 0;
+  std::size_t sum = 0;
+  while (consumed < producers * count) {
+    std::size_t n = ring.consume([&sum](std::size_t v) { sum += v; }, 16);
+    if (n == 0) {
+      std::this_thread::yield();
+    }
+    consumed += n;
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(done.load(), producers);
+  EXPECT_EQ(ring.shards(), producers);
+  EXPECT_EQ(sum, producers * count * (count + 1) / 2);
+}
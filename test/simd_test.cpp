@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <ouroboros/cyclic_deque.hpp>
+#include <ouroboros/simd.hpp>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+using ouroboros::simd::level;
+
+//! \brief Restores the detected instruction set at the end of a test.
+class SimdTest : public ::testing::Test {
+ protected:
+  void TearDown() override {
+    ouroboros::simd::set_level(ouroboros::simd::supported_level());
+  }
+
+  //! \brief Return the instruction sets the processor supports.
+  static std::vector<level> SupportedLevels() {
+    std::vector<level> result;
+    for (level l : {level::scalar, level::sse2, level::avx2, level::avx512}) {
+      if (l <= ouroboros::simd::supported_level()) {
+        result.push_back(l);
+      }
+    }
+    return result;
+  }
+};
+
+//! \brief Return a full ring of \p n values that starts \p offset elements
+//! into its buffer. For 0 < offset < n, the values wrap around the end of the
+//! buffer, such that both segments are used.
+template <typename T_>
+ouroboros::cyclic_deque<T_> MakeRing(
+    std::size_t n, std::size_t offset, std::mt19937& gen) {
+  ouroboros::cyclic_deque<T_> r(n);
+  for (std::size_t i = 0; i < offset; ++i) {
+    r.push_back(T_(0));
+  }
+  r.pop_front(offset);
+  std::uniform_int_distribution<int> dist(-50, 50);
+  for (std::size_t i = 0; i < n; ++i) {
+    r.push_back(static_cast<T_>(dist(gen)));
+  }
+  return r;
+}
+
+template <typename T_>
+void ExpectKernels(std::size_t n, std::size_t offset) {
+  std::mt19937 gen(static_cast<unsigned>(n * 31 + offset));
+  // The segments of r and q are split at different positions.
+  auto r = MakeRing<T_>(n, offset, gen);
+  auto q = MakeRing<T_>(n, n == 0 ? 0 : (offset + 1 + n / 3) % n, gen);
+  if (offset != 0) {
+    ASSERT_FALSE(r.used_segments()[1].empty());
+  }
+  std::vector<T_> v(r.begin(), r.end());
+  std::vector<T_> w(q.begin(), q.end());
+
+  // Integer results wrap around, like unsigned arithmetic.
+  using wide = std::conditional_t<std::is_integral_v<T_>, std::uint64_t, T_>;
+  wide sum = 0;
+  wide dot = 0;
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    sum += static_cast<wide>(v[i]);
+    dot += static_cast<wide>(v[i]) * static_cast<wide>(w[i]);
+    count += v[i] == T_(3) ? 1 : 0;
+  }
+  // Small integer values keep floating-point sums exact.
+  EXPECT_EQ(ouroboros::simd::sum(r), static_cast<T_>(sum));
+  EXPECT_EQ(ouroboros::simd::dot(r, q), static_cast<T_>(dot));
+  EXPECT_EQ(ouroboros::simd::count_if_eq(r, T_(3)), count);
+  if (n > 0) {
+    auto m = std::minmax_element(v.begin(), v.end());
+    EXPECT_EQ(ouroboros::simd::min(r), *m.first);
+    EXPECT_EQ(ouroboros::simd::max(r), *m.second);
+  }
+
+  ouroboros::simd::scale(r, T_(2));
+  for (std::size_t i = 0; i < n; ++i) {
+    ASSERT_EQ(r[i], static_cast<T_>(static_cast<wide>(v[i]) * 2));
+  }
+}
+
+template <typename T_>
+void ExpectKernelsForAllSizes() {
+  for (std::size_t n : {0, 1, 3, 17, 64, 100, 257, 1000}) {
+    for (std::size_t offset : {0, 1, 5, 33}) {
+      ExpectKernels<T_>(n, n == 0 ? 0 : offset % n);
+    }
+  }
+}
+
+}  // namespace
+
+TEST_F(SimdTest, Levels) {
+  EXPECT_EQ(ouroboros::simd::active_level(), ouroboros::simd::supported_level());
+  EXPECT_EQ(ouroboros::simd::set_level(level::scalar), level::scalar);
+  EXPECT_EQ(ouroboros::simd::active_level(), level::scalar);
+  EXPECT_EQ(
+      ouroboros::simd::set_level(level::avx512),
+      ouroboros::simd::supported_level());
+}
+
+TEST_F(SimdTest, Types) {
+  for (level l : SupportedLevels()) {
+    SCOPED_TRACE(static_cast<int>(l));
+    ouroboros::simd::set_level(l);
+    ExpectKernelsForAllSizes<float>();
+    ExpectKernelsForAllSizes<double>();
+    ExpectKernelsForAllSizes<std::int8_t>();
+    ExpectKernelsForAllSizes<std::int16_t>();
+    ExpectKernelsForAllSizes<std::int32_t>();
+    ExpectKernelsForAllSizes<std::int64_t>();
+    ExpectKernelsForAllSizes<std::uint32_t>();
+  }
+}
+
+TEST_F(SimdTest, Pointers) {
+  std::vector<std::int8_t> v(100000, 1);
+  v[12345] = -7;
+  v[99999] = 9;
+  for (level l : SupportedLevels()) {
+    ouroboros::simd::set_level(l);
+    // Exercises the periodic flush of the 8-bit lane counters.
+    EXPECT_EQ(
+        ouroboros::simd::count_if_eq(v.data(), v.size(), std::int8_t(1)),
+        v.size() - 2);
+    auto m = ouroboros::simd::minmax(v.data() + 1, v.size() - 1);
+    EXPECT_EQ(m.first, -7);
+    EXPECT_EQ(m.second, 9);
+  }
+}
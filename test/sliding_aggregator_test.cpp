@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <ouroboros/sliding_aggregator.hpp>
+#include <string>
+
+namespace {
+
+using matrix = std::array<long long, 4>;
+
+struct multiply {
+  matrix operator()(matrix const& a, matrix const& b) const {
+    return {a[0] * b[0] + a[1] * b[2], a[0] * b[1] + a[1] * b[3],
+            a[2] * b[0] + a[3] * b[2], a[2] * b[1] + a[3] * b[3]};
+  }
+};
+
+}  // namespace
+
+TEST(SlidingAggregatorTest, Sum) {
+  ouroboros::sliding_aggregator<int> w(3);
+  EXPECT_TRUE(w.empty());
+  EXPECT_EQ(w.query(), 0);
+  w.push(1);
+  w.push(2);
+  EXPECT_EQ(w.query(), 3);
+  w.push(3);
+  w.push(4);
+  EXPECT_TRUE(w.full());
+  EXPECT_EQ(w.query(), 9);
+  w.pop();
+  EXPECT_EQ(w.query(), 7);
+  w.push(5);
+  EXPECT_EQ(w.query(), 12);
+  w.clear();
+  EXPECT_EQ(w.query(), 0);
+  EXPECT_EQ(w.size(), 0);
+}
+
+TEST(SlidingAggregatorTest, NonCommutative) {
+  auto concat = [](std::string const& a, std::string const& b) {
+    return a + b;
+  };
+  ouroboros::sliding_aggregator<std::string, decltype(concat)> w(
+      3, std::string(), concat);
+  std::string letters = "abcdefgh";
+  for (std::size_t i = 0; i < letters.size(); ++i) {
+    w.push(std::string(1, letters[i]));
+    std::size_t first = i >= 2 ? i - 2 : 0;
+    EXPECT_EQ(w.query(), letters.substr(first, i - first + 1));
+  }
+}
+
+TEST(SlidingAggregatorTest, Matrix) {
+  // Products of [[1, 1], [1, 0]] are Fibonacci numbers.
+  ouroboros::sliding_aggregator<matrix, multiply> w(10, matrix{1, 0, 0, 1});
+  for (int i = 0; i < 100; ++i) {
+    w.push(matrix{1, 1, 1, 0});
+  }
+  EXPECT_EQ(w.query()[1], 55);
+}
+
+TEST(SlidingAggregatorTest, FlipBoundaries) {
+  // Runs of pushes and pops of every length make pop() find the front part
+  // empty after every possible number of values, including a single value, a
+  // back part filled by evictions and one that holds only new values.
+  constexpr std::size_t n = 6;
+  auto concat = [](std::string const& a, std::string const& b) {
+    return a + b;
+  };
+  ouroboros::sliding_aggregator<std::string, decltype(concat)> w(
+      n, std::string(), concat);
+  std::string expected;
+  char next = 'a';
+  for (std::size_t pushes = 1; pushes <= n + 1; ++pushes) {
+    for (std::size_t pops = 1; pops <= n; ++pops) {
+      for (std::size_t i = 0; i < pushes; ++i) {
+        std::string v(1, next);
+        next = next == 'z' ? 'a' : static_cast<char>(next + 1);
+        w.push(v);
+        expected += v;
+        if (expected.size() > n) {
+          expected.erase(0, 1);
+        }
+        ASSERT_EQ(w.query(), expected);
+      }
+      for (std::size_t i = 0; i < pops && !expected.empty(); ++i) {
+        w.pop();
+        expected.erase(0, 1);
+        ASSERT_EQ(w.query(), expected);
+      }
+    }
+  }
+}
@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+
+#include <deque>
+#include <functional>
+#include <ouroboros/sliding_min_max.hpp>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+
+std::size_t allocations = 0;
+
+template <typename T_>
+struct counting_allocator {
+  using value_type = T_;
+
+  counting_allocator() = default;
+
+  template <typename U_>
+  counting_allocator(counting_allocator<U_> const&) noexcept {}
+
+  T_* allocate(std::size_t n) {
+    ++allocations;
+    return std::allocator<T_>().allocate(n);
+  }
+
+  void deallocate(T_* p, std::size_t n) noexcept {
+    std::allocator<T_>().deallocate(p, n);
+  }
+
+  template <typename U_>
+  bool operator==(counting_allocator<U_> const&) const noexcept {
+    return true;
+  }
+
+  template <typename U_>
+  bool operator!=(counting_allocator<U_> const&) const noexcept {
+    return false;
+  }
+};
+
+// Throws when copied while fail is set.
+struct fragile {
+  fragile(int v = 0) : value(v) {}
+
+  fragile(fragile const& other) : value(other.value) { check(); }
+
+  fragile& operator=(fragile const& other) {
+    check();
+    value = other.value;
+    return *this;
+  }
+
+  static void check() {
+    if (fail) {
+      throw std::runtime_error("copy");
+    }
+  }
+
+  friend bool operator<(fragile const& a, fragile const& b) {
+    return a.value < b.value;
+  }
+
+  static inline bool fail = false;
+  int value;
+};
+
+}  // namespace
+
+TEST(SlidingMinMaxTest, Basic) {
+  ouroboros::sliding_min_max<int> w(3);
+  EXPECT_TRUE(w.empty());
+  EXPECT_EQ(w.capacity(), 3);
+
+  w.push(5);
+  EXPECT_EQ(w.min(), 5);
+  EXPECT_EQ(w.max(), 5);
+  w.push(3);
+  w.push(8);
+  EXPECT_EQ(w.min(), 3);
+  EXPECT_EQ(w.max(), 8);
+  // Evicts 5.
+  w.push(4);
+  EXPECT_EQ(w.min(), 3);
+  EXPECT_EQ(w.max(), 8);
+  // Evicts 3.
+  w.push(6);
+  EXPECT_EQ(w.min(), 4);
+  // Evicts 8.
+  w.push(1);
+  EXPECT_EQ(w.min(), 1);
+  EXPECT_EQ(w.max(), 6);
+
+  w.pop();
+  w.pop();
+  EXPECT_EQ(w.size(), 1);
+  EXPECT_EQ(w.min(), 1);
+  EXPECT_EQ(w.max(), 1);
+
+  w.clear();
+  EXPECT_TRUE(w.empty());
+  w.push(9);
+  EXPECT_EQ(w.min(), 9);
+  EXPECT_EQ(w.max(), 9);
+}
+
+TEST(SlidingMinMaxTest, Compare) {
+  ouroboros::sliding_min_max<std::string, std::greater<std::string>> w(2);
+  w.push("b");
+  w.push("a");
+  EXPECT_EQ(w.min(), "b");
+  EXPECT_EQ(w.max(), "a");
+  w.push("c");
+  EXPECT_EQ(w.min(), "c");
+  EXPECT_EQ(w.max(), "a");
+}
+
+TEST(SlidingMinMaxTest, Exceptions) {
+  // A throwing copy leaves the candidates as they were.
+  ouroboros::sliding_min_max<fragile> w(3);
+  w.push(5);
+  w.push(3);
+  fragile::fail = true;
+  EXPECT_THROW(w.push(1), std::runtime_error);
+  fragile::fail = false;
+  EXPECT_EQ(w.size(), 2);
+  EXPECT_EQ(w.min().value, 3);
+  EXPECT_EQ(w.max().value, 5);
+  w.push(4);
+  w.push(6);
+  EXPECT_EQ(w.min().value, 3);
+  EXPECT_EQ(w.max().value, 6);
+}
+
+TEST(SlidingMinMaxTest, EqualRuns) {
+  // Runs of equal keys of every length up to twice the window, such that
+  // evictions remove the oldest values of a run of equal minimums or maximums
+  // while later ones remain. Of equal keys, the latest value is returned.
+  constexpr std::size_t n = 7;
+  using value = std::pair<int, int>;
+  auto by_key = [](value const& a, value const& b) {
+    return a.first < b.first;
+  };
+  ouroboros::sliding_min_max<value, decltype(by_key)> w(n, by_key);
+  std::deque<value> expected;
+  int id = 0;
+  for (int length = 1; length <= 2 * static_cast<int>(n); ++length) {
+    int key = (length * 5) % 3;
+    for (int i = 0; i < length; ++i) {
+      value v{key, id++};
+      w.push(v);
+      expected.push_back(v);
+      if (expected.size() > n) {
+        expected.pop_front();
+      }
+      value min = expected.front();
+      value max = expected.front();
+      for (auto const& v : expected) {
+        if (v.first <= min.first) {
+          min = v;
+        }
+        if (v.first >= max.first) {
+          max = v;
+        }
+      }
+      ASSERT_EQ(w.min(), min);
+      ASSERT_EQ(w.max(), max);
+    }
+  }
+}
+
+TEST(SlidingMinMaxTest, NoAllocation) {
+  ouroboros::sliding_min_max<int, std::less<int>, counting_allocator<int>> w(
+      16);
+  std::size_t before = allocations;
+  for (int i = 0; i < 1000; ++i) {
+    w.push(i % 2 == 0 ? i : -i);
+  }
+  EXPECT_EQ(allocations, before);
+  EXPECT_EQ(w.min(), -999);
+  EXPECT_EQ(w.max(), 998);
+}
@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <ouroboros/sliding_quantile.hpp>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+TEST(SlidingQuantileTest, Basic) {
+  ouroboros::sliding_quantile<int> w(5);
+  EXPECT_TRUE(w.empty());
+  EXPECT_EQ(w.capacity(), 5);
+
+  for (int v : {50, 10, 40, 20, 30}) {
+    w.push(v);
+  }
+  EXPECT_TRUE(w.full());
+  EXPECT_EQ(w.select(0), 10);
+  EXPECT_EQ(w.select(4), 50);
+  EXPECT_EQ(w.median(), 30);
+  EXPECT_EQ(w.quantile(0.0), 10);
+  EXPECT_EQ(w.quantile(0.2), 10);
+  EXPECT_EQ(w.quantile(0.21), 20);
+  EXPECT_EQ(w.quantile(0.99), 50);
+  EXPECT_EQ(w.quantile(1.0), 50);
+  EXPECT_EQ(w.rank(30), 2);
+  EXPECT_EQ(w.rank(35), 3);
+
+  // Evicts 50.
+  w.push(60);
+  EXPECT_EQ(w.window().front(), 10);
+  EXPECT_EQ(w.select(3), 40);
+  EXPECT_EQ(w.select(4), 60);
+
+  w.pop();
+  EXPECT_EQ(w.size(), 4);
+  EXPECT_EQ(w.select(0), 20);
+  // The lower of the two middle values.
+  EXPECT_EQ(w.median(), 30);
+
+  w.clear();
+  EXPECT_TRUE(w.empty());
+  w.push(7);
+  EXPECT_EQ(w.median(), 7);
+}
+
+TEST(SlidingQuantileTest, Compare) {
+  ouroboros::sliding_quantile<int, std::greater<int>> w(3);
+  w.push(1);
+  w.push(3);
+  w.push(2);
+  EXPECT_EQ(w.select(0), 3);
+  EXPECT_EQ(w.quantile(1.0), 1);
+}
+
+TEST(SlidingQuantileTest, Equivalent) {
+  // Values are only compared by key, so pop() must find the node that was
+  // pushed as the oldest value, not any node with the same key.
+  using value = std::pair<int, int>;
+  auto by_key = [](value const& a, value const& b) {
+    return a.first < b.first;
+  };
+  ouroboros::sliding_quantile<value, decltype(by_key)> w(2, by_key);
+  w.push({5, 1});
+  w.push({5, 2});
+  w.push({7, 3});
+  EXPECT_EQ(w.select(0), (value{5, 2}));
+  EXPECT_EQ(w.select(1), (value{7, 3}));
+
+  constexpr std::size_t n = 31;
+  ouroboros::sliding_quantile<value, decltype(by_key)> r(n, by_key);
+  std::deque<value> expected;
+  std::mt19937 gen(5);
+  std::uniform_int_distribution<int> dist(0, 5);
+  for (int i = 0; i < 2000; ++i) {
+    if (!expected.empty() && i % 7 == 0) {
+      r.pop();
+      expected.pop_front();
+    } else {
+      value v{dist(gen), i};
+      r.push(v);
+      expected.push_back(v);
+      if (expected.size() > n) {
+        expected.pop_front();
+      }
+    }
+    // Equivalent values are ordered oldest first.
+    std::vector<value> sorted(expected.begin(), expected.end());
+    std::stable_sort(sorted.begin(), sorted.end(), by_key);
+    for (std::size_t k = 0; k < sorted.size(); ++k) {
+      ASSERT_EQ(r.select(k), sorted[k]);
+    }
+  }
+}
+
+namespace {
+
+// Throws when copied while copies_left is zero.
+struct fragile {
+  fragile(int v = 0) : value(v) {}
+
+  fragile(fragile const& other) : value(other.value) { count(); }
+
+  fragile& operator=(fragile const& other) {
+    count();
+    value = other.value;
+    return *this;
+  }
+
+  static void count() {
+    if (copies_left == 0) {
+      throw std::runtime_error("copy");
+    }
+    --copies_left;
+  }
+
+  friend bool operator<(fragile const& a, fragile const& b) {
+    return a.value < b.value;
+  }
+
+  static inline int copies_left = -1;
+  int value;
+};
+
+}  // namespace
+
+TEST(SlidingQuantileTest, Exceptions) {
+  // A throwing copy leaves the window and the tree as they were.
+  ouroboros::sliding_quantile<fragile> w(3);
+  w.push(3);
+  w.push(1);
+  for (int copies : {0, 1}) {
+    fragile::copies_left = copies;
+    EXPECT_THROW(w.push(2), std::runtime_error);
+    fragile::copies_left = -1;
+    EXPECT_EQ(w.size(), 2);
+    EXPECT_EQ(w.select(0).value, 1);
+    EXPECT_EQ(w.select(1).value, 3);
+  }
+
+  // No node was lost.
+  for (int v : {4, 5, 6, 7}) {
+    w.push(v);
+  }
+  EXPECT_EQ(w.select(0).value, 5);
+  EXPECT_EQ(w.select(2).value, 7);
+  while (!w.empty()) {
+    w.pop();
+  }
+}
+
+TEST(SlidingQuantileTest, EvictDuplicates) {
+  // Runs of duplicates of every length up to twice the window, such that the
+  // window is often made of a single value and most evictions remove one of
+  // several duplicates.
+  constexpr std::size_t n = 9;
+  ouroboros::sliding_quantile<int> w(n);
+  std::deque<int> expected;
+  auto check = [&]() {
+    ASSERT_EQ(w.size(), expected.size());
+    std::vector<int> sorted(expected.begin(), expected.end());
+    std::sort(sorted.begin(), sorted.end());
+    for (std::size_t k = 0; k < sorted.size(); ++k) {
+      ASSERT_EQ(w.select(k), sorted[k]);
+    }
+    for (int v = 0; v <= 4; ++v) {
+      ASSERT_EQ(
+          w.rank(v),
+          static_cast<std::size_t>(
+              std::lower_bound(sorted.begin(), sorted.end(), v) -
+              sorted.begin()));
+    }
+  };
+  for (std::size_t length = 1; length <= 2 * n; ++length) {
+    int v = static_cast<int>(length % 4);
+    for (std::size_t i = 0; i < length; ++i) {
+      w.push(v);
+      expected.push_back(v);
+      if (expected.size() > n) {
+        expected.pop_front();
+      }
+      check();
+    }
+    for (std::size_t i = 0; i < length / 3 && !expected.empty(); ++i) {
+      w.pop();
+      expected.pop_front();
+      check();
+    }
+  }
+}
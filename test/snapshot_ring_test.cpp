@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <ouroboros/snapshot_ring.hpp>
+#include <thread>
+#include <vector>
+
+TEST(SnapshotRingTest, Snapshot) {
+  ouroboros::snapshot_ring<int> ring(3);
+  EXPECT_EQ(ring.capacity(), 3);
+  EXPECT_EQ(ring.size(), 0);
+  int v;
+  EXPECT_FALSE(ring.latest(v));
+  EXPECT_TRUE(ring.snapshot(4).empty());
+
+  ring.push(0);
+  ring.push(1);
+  EXPECT_EQ(ring.size(), 2);
+  EXPECT_EQ(ring.snapshot(4), (std::vector<int>{0, 1}));
+
+  for (int i = 2; i < 7; ++i) {
+    ring.push(i);
+  }
+  EXPECT_EQ(ring.size(), 3);
+  EXPECT_EQ(ring.written(), 7);
+  EXPECT_EQ(ring.snapshot(8), (std::vector<int>{4, 5, 6}));
+  EXPECT_EQ(ring.snapshot(2), (std::vector<int>{5, 6}));
+  EXPECT_TRUE(ring.latest(v));
+  EXPECT_EQ(v, 6);
+
+  int out[4];
+  EXPECT_EQ(ring.try_snapshot(out, 3), 3);
+  EXPECT_EQ(out[0], 4);
+  EXPECT_EQ(out[2], 6);
+}
+
+TEST(SnapshotRingTest, ConcurrentReaders) {
+  struct sample {
+    std::uint64_t sequence;
+    std::uint64_t check;
+  };
+  constexpr std::uint64_t count = 200000;
+  constexpr std::size_t n = 16;
+  ouroboros::snapshot_ring<sample> ring(64);
+  std::atomic<bool> done{false};
+  std::atomic<bool> consistent{true};
+
+  std::vector<std::thread> readers;
+  for (int r = 0; r < 2; ++r) {
+    readers.emplace_back([&]() {
+      sample out[n];
+      while (!done.load()) {
+        std::size_t m = ring.snapshot(out, n);
+        // The elements are intact and consecutive.
+        for (std::size_t i = 0; i < m; ++i) {
+          if (out[i].check != ~out[i].sequence ||
+              (i > 0 && out[i].sequence != out[i - 1].sequence + 1)) {
+            consistent = false;
+          }
+        }
+        std::this_thread::yield();
+      }
+    });
+  }
+
+  for (std::uint64_t i = 0; i < count; ++i) {
+    ring.push(sample{i, ~i});
+  }
+  done = true;
+  for (auto& r : readers) {
+    r.join();
+  }
+  EXPECT_TRUE(consistent.load());
+  sample last;
+  EXPECT_TRUE(ring.latest(last));
+  EXPECT_EQ(last.sequence, count - 1);
+}
+
+TEST(SnapshotRingTest, FullSnapshot) {
+  // A push during the copy doesn't overwrite any of the latest capacity()
+  // elements.
+  constexpr std::uint64_t count = 200000;
+  ouroboros::snapshot_ring<std::uint64_t> ring(7);
+  std::atomic<bool> done{false};
+  std::atomic<bool> consistent{true};
+
+  std::thread reader([&]() {
+    std::vector<std::uint64_t> out(ring.capacity());
+    while (!done.load()) {
+      bool full = ring.written() >= ring.capacity();
+      std::size_t m = ring.snapshot(out.data(), ring.capacity());
+      if (full && m != ring.capacity()) {
+        consistent = false;
+      }
+      for (std::size_t i = 1; i < m; ++i) {
+        if (out[i] != out[i - 1] + 1) {
+          consistent = false;
+        }
+      }
+    }
+  });
+
+  for (std::uint64_t i = 0; i < count; ++i) {
+    ring.push(i);
+  }
+  done = true;
+  reader.join();
+  EXPECT_TRUE(consistent.load());
+  EXPECT_EQ(ring.snapshot(ring.capacity()).back(), count - 1);
+}
+
+TEST(SnapshotRingTest, PowerOfTwoCapacity) {
+  // The capacity() + 1 slots wrap at a position that isn't a power of two.
+  ouroboros::snapshot_ring<int> ring(4);
+  for (int i = 0; i < 23; ++i) {
+    ring.push(i);
+    std::vector<int> expected;
+    for (int j = std::max(0, i - 3); j <= i; ++j) {
+      expected.push_back(j);
+    }
+    EXPECT_EQ(ring.snapshot(4), expected);
+  }
+}
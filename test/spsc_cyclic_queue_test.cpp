@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <ouroboros/spsc_cyclic_queue.hpp>
+#include <thread>
+
+TEST(SpscCyclicQueueTest, PushPop) {
+  ouroboros::spsc_cyclic_queue<std::size_t> queue(3);
+  EXPECT_EQ(queue.capacity(), 3);
+  EXPECT_TRUE(queue.empty());
+
+  std::size_t v;
+  EXPECT_FALSE(queue.try_pop(v));
+  for (std::size_t i = 0; i < 10; ++i) {
+    EXPECT_TRUE(queue.try_push(i));
+    EXPECT_TRUE(queue.try_push(i + 1));
+    EXPECT_TRUE(queue.try_push(i + 2));
+    EXPECT_FALSE(queue.try_push(i + 3));
+    EXPECT_EQ(queue.size(), 3);
+    for (std::size_t j = 0; j < 3; ++j) {
+      EXPECT_TRUE(queue.try_pop(v));
+      EXPECT_EQ(v, i + j);
+    }
+    EXPECT_FALSE(queue.try_pop(v));
+  }
+}
+
+TEST(SpscCyclicQueueTest, Batched) {
+  ouroboros::spsc_cyclic_queue<std::size_t> queue(8);
+  std::vector<std::size_t> in(12);
+  std::iota(in.begin(), in.end(), 0);
+  std::vector<std::size_t> out;
+
+  EXPECT_EQ(queue.try_push_n(in.begin(), 5), 5);
+  EXPECT_EQ(queue.try_pop_n(std::back_inserter(out), 3), 3);
+  // Wraps around the end of the buffer and gets truncated to the capacity.
+  EXPECT_EQ(queue.try_push_n(in.begin() + 5, 7), 6);
+  EXPECT_EQ(queue.size(), 8);
+  EXPECT_EQ(queue.try_push_n(in.begin(), 1), 0);
+  EXPECT_EQ(queue.try_pop_n(std::back_inserter(out), 100), 8);
+  EXPECT_EQ(out.size(), 11);
+  EXPECT_TRUE(std::equal(out.begin(), out.end(), in.begin()));
+}
+
+TEST(SpscCyclicQueueTest, ProducerConsumer) {
+  constexpr std::size_t count = 100000;
+  ouroboros::spsc_cyclic_queue<std::size_t> queue(64);
+
+  std::thread producer([&queue]() {
+    std::size_t batch[7];
+    std::size_t i = 0;
+    while (i < count) {
+      if (i % 3 == 0) {
+        std::size_t n = std::min<std::size_t>(7, count - i);
+        std::iota(batch, batch + n, i);
+        std::size_t pushed = 0;
+        while (pushed < n) {
+          pushed += queue.try_push_n(batch + pushed, n - pushed);
+          if (pushed < n) {
+            std::this_thread::yield();
+          }
+        }
+        i += n;
+      } else {
+        while (!queue.try_push(i)) {
+          std::this_thread::yield();
+        }
+        ++i;
+      }
+    }
+  });
+
+  std::size_t expected = 0;
+  std::size_t batch[5];
+  while (expected < count) {
+    std::size_t n = queue.try_pop_n(batch, 5);
+    for (std::size_t i = 0; i < n; ++i) {
+      ASSERT_EQ(batch[i], expected++);
+    }
+    std::size_t v;
+    if (queue.try_pop(v)) {
+      ASSERT_EQ(v, expected++);
+    } else if (n == 0) {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  EXPECT_TRUE(queue.empty());
+}
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <ouroboros/thread_pool.hpp>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+long fib(ouroboros::thread_pool& pool, int n) {
+  if (n < 2) {
+    return n;
+  }
+  long a = 0;
+  long b = 0;
+  pool.fork_join(
+      [&]() { a = fib(pool, n - 1); }, [&]() { b = fib(pool, n - 2); });
+  return a + b;
+}
+
+}  // namespace
+
+TEST(ThreadPoolTest, Submit) {
+  ouroboros::thread_pool pool(4);
+  EXPECT_EQ(pool.size(), 4);
+
+  std::atomic<int> count{0};
+  for (int i = 0; i < 1000; ++i) {
+    pool.submit([&count]() { ++count; });
+  }
+  pool.wait_idle();
+  EXPECT_EQ(count.load(), 1000);
+
+  // Tasks may submit other tasks.
+  for (int i = 0; i < 10; ++i) {
+    pool.submit([&pool, &count]() {
+      for (int j = 0; j < 10; ++j) {
+        pool.submit([&count]() { ++count; });
+      }
+    });
+  }
+  pool.wait_idle();
+  EXPECT_EQ(count.load(), 1100);
+}
+
+TEST(ThreadPoolTest, ForkJoin) {
+  ouroboros::thread_pool pool(4);
+  // From outside of and from within the pool.
+  EXPECT_EQ(fib(pool, 20), 6765);
+  std::atomic<long> result{0};
+  pool.submit([&]() { result = fib(pool, 20); });
+  pool.wait_idle();
+  EXPECT_EQ(result.load(), 6765);
+}
+
+TEST(ThreadPoolTest, ParallelFor) {
+  ouroboros::thread_pool pool(3);
+  std::vector<int> v(10000, 0);
+  auto f = [&v](std::size_t i) { v[i] += static_cast<int>(i); };
+  pool.parallel_for(std::size_t{0}, v.size(), std::size_t{64}, f);
+  for (std::size_t i = 0; i < v.size(); ++i) {
+    ASSERT_EQ(v[i], static_cast<int>(i));
+  }
+
+  // An empty range and a grain of zero.
+  pool.parallel_for(5, 5, 0, [](int) { FAIL(); });
+  std::atomic<int> count{0};
+  pool.parallel_for(0, 10, 0, [&count](int) { ++count; });
+  EXPECT_EQ(count.load(), 10);
+}
+
+TEST(ThreadPoolTest, Exceptions) {
+  ouroboros::thread_pool pool(4);
+  std::atomic<int> count{0};
+  auto count_after_yield = [&count]() {
+    std::this_thread::yield();
+    ++count;
+  };
+  auto fail = []() { throw std::runtime_error("fail"); };
+
+  // The forked task is done before the exception of the first one leaves
+  // fork_join().
+  EXPECT_THROW(pool.fork_join(fail, count_after_yield), std::runtime_error);
+  EXPECT_EQ(count.load(), 1);
+  EXPECT_THROW(pool.fork_join(count_after_yield, fail), std::runtime_error);
+  EXPECT_EQ(count.load(), 2);
+
+  // From within the pool and through nested fork/join.
+  std::atomic<int> caught{0};
+  for (int i = 0; i < 8; ++i) {
+    pool.submit([&]() {
+      try {
+        pool.parallel_for(0, 64, 1, [](int j) {
+          if (j == 37) {
+            throw std::runtime_error("fail");
+          }
+        });
+      } catch (std::runtime_error const&) {
+        ++caught;
+      }
+    });
+  }
+  pool.wait_idle();
+  EXPECT_EQ(caught.load(), 8);
+
+  // A submitted task rethrows from wait_idle(), once.
+  pool.submit(fail);
+  pool.submit(count_after_yield);
+  EXPECT_THROW(pool.wait_idle(), std::runtime_error);
+  EXPECT_EQ(count.load(), 3);
+  EXPECT_NO_THROW(pool.wait_idle());
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <ouroboros/sliding_aggregator.hpp>
+#include <ouroboros/time_window.hpp>
+#include <ouroboros/windowed_stats.hpp>
+#include <random>
+#include <vector>
+
+namespace {
+
+//! \brief A manually advanced clock.
+struct test_clock {
+  using rep = std::int64_t;
+  using period = std::milli;
+  using duration = std::chrono::duration<rep, period>;
+  using time_point = std::chrono::time_point<test_clock>;
+  static constexpr bool is_steady = true;
+};
+
+using ms = std::chrono::milliseconds;
+
+test_clock::time_point at(std::int64_t t) {
+  return test_clock::time_point(ms(t));
+}
+
+}  // namespace
+
+TEST(TimeWindowTest, Advance) {
+  ouroboros::time_window<int, test_clock> w(ms(10), 2);
+  EXPECT_TRUE(w.empty());
+  EXPECT_EQ(w.span(), ms(10));
+  EXPECT_EQ(w.advance(at(100)), 0);
+
+  w.push(at(1), 1);
+  w.push(at(2), 2);
+  // Grows.
+  w.push(at(2), 3);
+  w.push(at(5), 4);
+  w.push(at(11), 5);
+  EXPECT_EQ(w.size(), 5);
+  EXPECT_GE(w.capacity(), 5);
+
+  // Keeps the values after 11 - 10.
+  EXPECT_EQ(w.advance(at(11)), 1);
+  EXPECT_EQ(w.front().value, 2);
+  std::vector<int> evicted;
+  EXPECT_EQ(
+      w.advance(at(12), [&evicted](int v) { evicted.push_back(v); }), 2);
+  EXPECT_EQ(evicted, (std::vector<int>{2, 3}));
+  EXPECT_EQ(w.front().time, at(5));
+  EXPECT_EQ(w.back().value, 5);
+
+  EXPECT_EQ(w.advance(at(21)), 2);
+  EXPECT_TRUE(w.empty());
+}
+
+TEST(TimeWindowTest, Segments) {
+  // Wraps around such that the values are split across both segments.
+  ouroboros::time_window<int, test_clock> w(ms(5), 8);
+  std::deque<std::int64_t> expected;
+  std::mt19937 gen(1);
+  std::uniform_int_distribution<int> step(0, 2);
+  std::int64_t now = 0;
+  for (int i = 0; i < 2000; ++i) {
+    now += step(gen);
+    w.push(at(now), i);
+    expected.push_back(now);
+    std::size_t n = 0;
+    while (!expected.empty() && expected.front() <= now - 5) {
+      expected.pop_front();
+      ++n;
+    }
+    ASSERT_EQ(w.advance(at(now)), n);
+    ASSERT_EQ(w.size(), expected.size());
+    ASSERT_EQ(w.front().time, at(expected.front()));
+  }
+  // No growth was needed beyond the largest number of values in a span.
+  EXPECT_LE(w.capacity(), 16);
+}
+
+TEST(TimeWindowTest, Aggregators) {
+  ouroboros::time_window<double, test_clock> w(ms(3));
+  ouroboros::windowed_stats<double> stats(8);
+  auto max = [](double a, double b) { return a < b ? b : a; };
+  ouroboros::sliding_aggregator<double, decltype(max)> highest(8, -1.0, max);
+  auto evict = [&](double) {
+    stats.pop();
+    highest.pop();
+  };
+
+  std::int64_t t = 0;
+  for (double v : {4.0, 2.0, 6.0, 1.0, 3.0}) {
+    ++t;
+    w.push(at(t), v);
+    stats.push(v);
+    highest.push(v);
+    w.advance(at(t), evict);
+  }
+  // The values at 3, 4 and 5.
+  EXPECT_EQ(stats.size(), 3);
+  EXPECT_DOUBLE_EQ(stats.sum(), 10.0);
+  EXPECT_EQ(highest.query(), 6.0);
+
+  w.advance(at(7), evict);
+  EXPECT_EQ(stats.size(), 1);
+  EXPECT_EQ(highest.query(), 3.0);
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <ouroboros/timer_wheel.hpp>
+#include <random>
+#include <vector>
+
+TEST(TimerWheelTest, ScheduleCancel) {
+  ouroboros::timer_wheel<int> wheel(100);
+  EXPECT_EQ(wheel.now(), 100);
+  auto h1 = wheel.schedule(105, 1);
+  auto h2 = wheel.schedule(103, 2);
+  // In the past: expires at the next tick.
+  auto h3 = wheel.schedule(50, 3);
+  EXPECT_EQ(wheel.size(), 3);
+  EXPECT_TRUE(wheel.active(h1));
+  EXPECT_NE(h1, h2);
+
+  EXPECT_TRUE(wheel.cancel(h2));
+  EXPECT_FALSE(wheel.cancel(h2));
+  EXPECT_FALSE(wheel.active(h2));
+  EXPECT_FALSE(wheel.cancel(ouroboros::timer_wheel<int>::handle()));
+
+  std::vector<int> expired;
+  auto f = [&expired](int v) { expired.push_back(v); };
+  EXPECT_EQ(wheel.advance(104, f), 1);
+  EXPECT_EQ(expired, (std::vector<int>{3}));
+  EXPECT_FALSE(wheel.active(h3));
+  EXPECT_EQ(wheel.advance(110, f), 1);
+  EXPECT_EQ(expired, (std::vector<int>{3, 1}));
+  EXPECT_TRUE(wheel.empty());
+
+  // A recycled node doesn't make an old handle active again.
+  auto h4 = wheel.schedule(200, 4);
+  EXPECT_FALSE(wheel.active(h1));
+  EXPECT_TRUE(wheel.active(h4));
+}
+
+TEST(TimerWheelTest, Cascade) {
+  // Two levels of 4 buckets cover 16 ticks. Later timers are rescheduled at
+  // the top level.
+  ouroboros::timer_wheel<std::uint64_t> wheel(3, 2, 2);
+  std::vector<std::uint64_t> expiries = {4, 5, 7, 8, 15, 16, 19, 20, 35, 100};
+  for (auto e : expiries) {
+    wheel.schedule(e, e);
+  }
+  std::vector<std::uint64_t> expired;
+  for (std::uint64_t t = 4; t <= 100; ++t) {
+    wheel.advance(t, [&](std::uint64_t e) {
+      EXPECT_EQ(e, t);
+      expired.push_back(e);
+    });
+  }
+  EXPECT_EQ(expired, expiries);
+}
+
+TEST(TimerWheelTest, Sparse) {
+  // Large advances skip the ticks at which nothing happens, including those
+  // of timers beyond the range of the top level.
+  ouroboros::timer_wheel<std::uint64_t> wheel(7);
+  std::vector<std::uint64_t> expiries = {
+      (std::uint64_t(1) << 24) + 5,
+      (std::uint64_t(1) << 31) + 9,
+      (std::uint64_t(1) << 40) + 3};
+  for (auto e : expiries) {
+    wheel.schedule(e, e);
+  }
+  std::vector<std::uint64_t> expired;
+  auto f = [&](std::uint64_t e) { expired.push_back(e); };
+  EXPECT_EQ(wheel.advance(expiries[0] - 1, f), 0);
+  EXPECT_EQ(wheel.now(), expiries[0] - 1);
+  EXPECT_EQ(wheel.advance(expiries[0], f), 1);
+  EXPECT_EQ(wheel.advance(std::uint64_t(1) << 41, f), 2);
+  EXPECT_EQ(wheel.now(), std::uint64_t(1) << 41);
+  EXPECT_EQ(expired, expiries);
+  EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TimerWheelTest, Random) {
+  // Compare against a multimap, with timers that reschedule and cancel others
+  // from within the callback.
+  std::mt19937_64 rng(7);
+  ouroboros::timer_wheel<std::uint64_t> wheel(0, 3, 4);
+  std::multimap<std::uint64_t, ouroboros::timer_wheel<std::uint64_t>::handle>
+      expected;
+  std::uint64_t id = 0;
+  std::vector<std::pair<std::uint64_t, std::uint64_t>> scheduled;
+  auto schedule = [&](std::uint64_t now) {
+    std::uint64_t e = now + 1 + rng() % 10000;
+    scheduled.emplace_back(id, e);
+    expected.emplace(e, wheel.schedule(e, id++));
+  };
+  for (int i = 0; i < 1000; ++i) {
+    schedule(0);
+  }
+
+  std::uint64_t now = 0;
+  std::size_t cancelled = 0;
+  while (!wheel.empty()) {
+    std::uint64_t before = now;
+    now += 1 + rng() % 50;
+    wheel.advance(now, [&](std::uint64_t v) {
+      EXPECT_LE(scheduled[v].second, now);
+      EXPECT_GT(scheduled[v].second, before);
+      auto it = expected.find(scheduled[v].second);
+      ASSERT_NE(it, expected.end());
+      expected.erase(it);
+      if (v % 3 == 0 && id < 3000) {
+        schedule(now);
+      }
+      if (v % 5 == 0 && !expected.empty()) {
+        auto last = std::prev(expected.end());
+        EXPECT_TRUE(wheel.cancel(last->second));
+        expected.erase(last);
+        ++cancelled;
+      }
+    });
+  }
+  EXPECT_TRUE(expected.empty());
+  EXPECT_GT(cancelled, 0);
+}
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <numeric>
+#include <ouroboros/windowed_stats.hpp>
+#include <random>
+
+namespace {
+
+struct exact_stats {
+  double sum;
+  double mean;
+  double variance;
+};
+
+exact_stats compute(std::deque<double> const& values) {
+  double sum = std::accumulate(values.begin(), values.end(), 0.0);
+  double mean = sum / static_cast<double>(values.size());
+  double m2 = 0.0;
+  for (double v : values) {
+    m2 += (v - mean) * (v - mean);
+  }
+  return {sum, mean, m2 / static_cast<double>(values.size())};
+}
+
+}  // namespace
+
+TEST(WindowedStatsTest, Basic) {
+  ouroboros::windowed_stats<int> w(3);
+  EXPECT_TRUE(w.empty());
+  EXPECT_EQ(w.capacity(), 3);
+  EXPECT_EQ(w.recompute_interval(), 3);
+  EXPECT_EQ(w.mean(), 0.0);
+  EXPECT_EQ(w.variance(), 0.0);
+
+  w.push(2);
+  w.push(4);
+  EXPECT_EQ(w.sum(), 6.0);
+  EXPECT_EQ(w.mean(), 3.0);
+  EXPECT_EQ(w.variance(), 1.0);
+  EXPECT_EQ(w.sample_variance(), 2.0);
+
+  w.push(6);
+  w.push(8);
+  EXPECT_TRUE(w.full());
+  EXPECT_EQ(w.window().front(), 4);
+  EXPECT_EQ(w.sum(), 18.0);
+  EXPECT_DOUBLE_EQ(w.mean(), 6.0);
+  EXPECT_DOUBLE_EQ(w.stddev(), std::sqrt(8.0 / 3.0));
+  EXPECT_DOUBLE_EQ(w.sample_stddev(), 2.0);
+
+  w.pop();
+  EXPECT_EQ(w.size(), 2);
+  EXPECT_DOUBLE_EQ(w.mean(), 7.0);
+  w.pop();
+  w.pop();
+  EXPECT_TRUE(w.empty());
+  EXPECT_EQ(w.sum(), 0.0);
+  EXPECT_EQ(w.mean(), 0.0);
+
+  w.push(1);
+  w.clear();
+  EXPECT_TRUE(w.empty());
+  EXPECT_EQ(w.sum(), 0.0);
+}
+
+TEST(WindowedStatsTest, Random) {
+  constexpr std::size_t n = 100;
+  ouroboros::windowed_stats<double> w(n);
+  std::deque<double> expected;
+  std::mt19937 gen(7);
+  std::normal_distribution<double> dist(5.0, 3.0);
+  for (int i = 0; i < 10000; ++i) {
+    double v = dist(gen);
+    w.push(v);
+    expected.push_back(v);
+    if (expected.size() > n) {
+      expected.pop_front();
+    }
+    if (i % 97 == 0) {
+      auto e = compute(expected);
+      EXPECT_NEAR(w.sum(), e.sum, 1e-9);
+      EXPECT_NEAR(w.mean(), e.mean, 1e-11);
+      EXPECT_NEAR(w.variance(), e.variance, 1e-9);
+    }
+  }
+}
+
+TEST(WindowedStatsTest, Drift) {
+  // Small deviations around a large offset cancel catastrophically in a naive
+  // running sum of squares. The recomputation bounds the drift.
+  constexpr std::size_t n = 64;
+  ouroboros::windowed_stats<double> w(n);
+  ouroboros::windowed_stats<double> never(n, std::size_t(-1));
+  std::deque<double> expected;
+  std::mt19937 gen(11);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  for (int i = 0; i < 200000; ++i) {
+    double v = 1e9 + dist(gen);
+    w.push(v);
+    never.push(v);
+    expected.push_back(v);
+    if (expected.size() > n) {
+      expected.pop_front();
+    }
+  }
+  auto e = compute(expected);
+  EXPECT_NEAR(w.mean(), e.mean, 1e-6);
+  EXPECT_NEAR(w.variance(), e.variance, 1e-6 * e.variance);
+
+  w.recompute();
+  EXPECT_NEAR(w.variance(), e.variance, 1e-6 * e.variance);
+  EXPECT_NEAR(never.sum(), e.sum, 1e-3);
+}
+
+TEST(WindowedStatsTest, Integers) {
+  ouroboros::windowed_stats<std::int64_t> w(4);
+  for (std::int64_t i = 1; i <= 1000; ++i) {
+    w.push(i);
+  }
+  EXPECT_EQ(w.sum(), 997.0 + 998.0 + 999.0 + 1000.0);
+  EXPECT_EQ(w.mean(), 998.5);
+  EXPECT_EQ(w.variance(), 1.25);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <ouroboros/cyclic_deque.hpp>
+
+// A ring of which the elements wrap around the end of the buffer.
+inline ouroboros::cyclic_deque<std::uint32_t> MakeWrappedRing(std::size_t n) {
+  ouroboros::cyclic_deque<std::uint32_t> r(n);
+  for (std::size_t i = 0; i < n / 3; ++i) {
+    r.push_back(0);
+  }
+  for (std::uint32_t i = 0; i < n; ++i) {
+    if (r.full()) {
+      r.pop_front();
+    }
+    r.push_back(i);
+  }
+  EXPECT_FALSE(r.used_segments()[1].empty());
+  return r;
+}
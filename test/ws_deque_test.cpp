@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <ouroboros/ws_deque.hpp>
+#include <thread>
+#include <vector>
+
+TEST(WsDequeTest, PushPopSteal) {
+  ouroboros::ws_deque<int> deque(4);
+  EXPECT_EQ(deque.capacity(), 4);
+
+  int v;
+  EXPECT_FALSE(deque.pop(v));
+  EXPECT_FALSE(deque.steal(v));
+  for (int i = 0; i < 4; ++i) {
+    deque.push(i);
+  }
+  EXPECT_EQ(deque.size(), 4);
+
+  // The owner pops in LIFO order, thieves steal in FIFO order.
+  EXPECT_TRUE(deque.pop(v));
+  EXPECT_EQ(v, 3);
+  EXPECT_TRUE(deque.steal(v));
+  EXPECT_EQ(v, 0);
+  EXPECT_TRUE(deque.pop(v));
+  EXPECT_EQ(v, 2);
+  EXPECT_TRUE(deque.steal(v));
+  EXPECT_EQ(v, 1);
+  EXPECT_FALSE(deque.pop(v));
+  EXPECT_FALSE(deque.steal(v));
+  EXPECT_TRUE(deque.empty());
+}
+
+TEST(WsDequeTest, Grow) {
+  ouroboros::ws_deque<int> deque(2);
+  int v;
+  // Move top away from zero such that the elements wrap when growing.
+  deque.push(-1);
+  EXPECT_TRUE(deque.steal(v));
+  for (int i = 0; i < 100; ++i) {
+    deque.push(i);
+  }
+  EXPECT_EQ(deque.capacity(), 128);
+  EXPECT_EQ(deque.size(), 100);
+  for (int i = 0; i < 50; ++i) {
+    EXPECT_TRUE(deque.steal(v));
+    EXPECT_EQ(v, i);
+  }
+  for (int i = 99; i >= 50; --i) {
+    EXPECT_TRUE(deque.pop(v));
+    EXPECT_EQ(v, i);
+  }
+  EXPECT_TRUE(deque.empty());
+}
+
+TEST(WsDequeTest, Thieves) {
+  constexpr std::size_t thieves = 3;
+  constexpr std::size_t count = 100000;
+  ouroboros::ws_deque<std::size_t> deque(8);
+  std::atomic<bool> done{false};
+  std::atomic<std::size_t> taken{0};
+  std::atomic<std::size_t> sum{0};
+
+  std::vector<std::thread> threads;
+  for (std::size_t t = 0; t < thieves; ++t) {
+    threads.emplace_back([&]() {
+      std::size_t v;
+      while (!done.load()) {
+        if (deque.steal(v)) {
+          sum += v;
+          ++taken;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  // Every element is taken exactly once, either by the owner or a thief.
+  std::size_t v;
+  for (std::size_t i = 1; i <= count; ++i) {
+    deque.push(i);
+    if (i % 3 == 0 && deque.pop(v)) {
+      sum += v;
+      ++taken;
+    }
+  }
+  while (deque.pop(v)) {
+    sum += v;
+    ++taken;
+  }
+  while (taken.load() < count) {
+    std::this_thread::yield();
+  }
+  done = true;
+  for (auto& t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(taken.load(), count);
+  EXPECT_EQ(sum.load(), count * (count + 1) / 2);
+}
+
+TEST(WsDequeTest, LostRaceKeepsValue) {
+  // When a thief takes the last element, pop() leaves the value untouched.
+  constexpr std::size_t count = 20000;
+  ouroboros::ws_deque<std::size_t> deque(8);
+  std::atomic<bool> done{false};
+
+  std::thread thief([&]() {
+    std::size_t v;
+    while (!done.load()) {
+      deque.steal(v);
+    }
+  });
+
+  bool untouched = true;
+  for (std::size_t i = 1; i <= count; ++i) {
+    deque.push(i);
+    std::size_t v = 0;
+    if (!deque.pop(v) && v != 0) {
+      untouched = false;
+    }
+  }
+  done = true;
+  thief.join();
+  EXPECT_TRUE(untouched);
+}